@@ -1,15 +1,29 @@
 #include <stdio.h>
 #include <assert.h>
 #include "csv.h"
+#include "csvreader.h"
 #include "api.h"
+#include "snapshot.h"
+#include "nodepool.h"
+#include "symbol.h"
 
 #include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
 #include "person.h"
 #include "winegrower.h"
 #include "vineyardplot.h"
 
 
-#define FILE_READ_BUFFER_SIZE 2048
+// Size of the chunks of file parsed by each thread in a parallel load
+#define API_LOAD_CHUNK_SIZE (4 * 1024 * 1024)
+
+// Initial value and multiplier of the FNV-1a checksum used by the incremental load
+#define API_CHECKSUM_BASIS 14695981039346656037ULL
+#define API_CHECKSUM_PRIME 1099511628211ULL
+
+// Bytes at the start and at the end of the applied part of the file covered by the checksum of the incremental load
+#define API_CHECKPOINT_WINDOW (64 * 1024)
 
 // Get the API version information
 const char* api_version() {
@@ -19,8 +33,9 @@ const char* api_version() {
 // Load data from a CSV file. If reset is true, remove previous data
 tApiError api_loadData(tApiData* data, const char* filename, bool reset) {
     tApiError error;
-    FILE *fin;    
-    char buffer[FILE_READ_BUFFER_SIZE];
+    tCSVReader reader;
+    const char* line;
+    int len;
     tCSVEntry entry;
     
     // Check input data
@@ -43,29 +58,301 @@ tApiError api_loadData(tApiData* data, const char* filename, bool reset) {
     }
 
     // Open the input file
-    fin = fopen(filename, "r");
-    if (fin == NULL) {
-        return E_FILE_NOT_FOUND;
+    error = csvReader_open(&reader, filename);
+    if (error != E_SUCCESS) {
+        return error;
     }
     
-    // Read file line by line
-    while (fgets(buffer, FILE_READ_BUFFER_SIZE, fin)) {
-        // Remove new line character     
-        buffer[strcspn(buffer, "\n\r")] = '\0';
-        
+    // Read file line by line. Lines are parsed directly from the reader data
+    while (csvReader_nextLine(&reader, &line, &len)) {
         csv_initEntry(&entry);
-        csv_parseEntry(&entry, buffer, NULL);
+        csv_parseEntryN(&entry, line, len, NULL);
         // Add this new entry to the api Data
         error = api_addDataEntry(data, entry);
+        csv_freeEntry(&entry);
         if (error != E_SUCCESS) {
+            csvReader_close(&reader);
             return error;
         }
+    }
+    
+    // A read error is not the end of the file: the data loaded is incomplete
+    if (csvReader_failed(&reader)) {
+        error = E_FILE_READ_ERROR;
+    }
+    csvReader_close(&reader);
+    
+    return error;
+}
+
+// Continue the FNV-1a checksum of a block of bytes
+static uint64_t api_checksum(uint64_t hash, const char* buffer, size_t len) {
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hash ^= (unsigned char) buffer[i];
+        hash *= API_CHECKSUM_PRIME;
+    }
+
+    return hash;
+}
+
+// Checksum of the first and last bytes of the first offset bytes of a file. Its cost does not depend on the
+// size of the file, and any change near the start or near the last row applied changes it
+static uint64_t api_checkpoint(const char* buffer, size_t offset) {
+    uint64_t hash;
+    size_t len;
+
+    len = (offset < API_CHECKPOINT_WINDOW) ? offset : API_CHECKPOINT_WINDOW;
+    hash = api_checksum(API_CHECKSUM_BASIS, buffer, len);
+    hash = api_checksum(hash, buffer + offset - len, len);
+
+    return hash;
+}
+
+// Load the rows appended to a CSV file since the previous call
+tApiError api_loadDataIncremental(tApiData* data, const char* filename) {
+    tApiError error, rowError;
+    tCSVReader reader, delta;
+    const char* line;
+    size_t size, applied;
+    int len;
+    tCSVEntry entry;
+
+    // Check input data
+    assert(data != NULL);
+    assert(filename != NULL);
+
+    // Open the input file
+    error = csvReader_open(&reader, filename);
+    if (error != E_SUCCESS) {
+        return error;
+    }
+
+    // Offsets are only meaningful for regular files. Otherwise, reload everything
+    if (!reader.mapped && !reader.eof) {
+        csvReader_close(&reader);
+        return api_loadData(data, filename, true);
+    }
+
+    // The last line may still be being written. Only consume up to the last line end
+    size = reader.size;
+    while (size > 0 && reader.data[size - 1] != '\n') {
+        size--;
+    }
+
+    // Start again if there is no checkpoint or the part already applied has changed. Only the windows
+    // of the checkpoint are read, so the pages of the rest of the applied part are not touched
+    if (data->loadOffset == 0 || data->loadOffset > size
+            || api_checkpoint(reader.data, data->loadOffset) != data->loadChecksum) {
+        error = api_freeData(data);
+        if (error == E_SUCCESS) {
+            error = api_initData(data);
+        }
+        if (error != E_SUCCESS) {
+            csvReader_close(&reader);
+            return error;
+        }
+    }
+
+    // Apply the new lines. A wrong row is consumed as the others, so the next call does not stop at it again.
+    // The error of the first wrong row is returned
+    applied = 0;
+    csvReader_openBuffer(&delta, reader.data + data->loadOffset, size - data->loadOffset);
+    while (csvReader_nextLine(&delta, &line, &len)) {
+        csv_initEntry(&entry);
+        csv_parseEntryN(&entry, line, len, NULL);
+        rowError = api_addDataEntry(data, entry);
         csv_freeEntry(&entry);
+        if (error == E_SUCCESS) {
+            error = rowError;
+        }
+        applied = delta.pos;
     }
+
+    // Move the checkpoint after the last line applied
+    data->loadOffset += applied;
+    data->loadChecksum = api_checkpoint(reader.data, data->loadOffset);
+
+    csvReader_close(&delta);
+    csvReader_close(&reader);
+
+    return error;
+}
+
+// Chunk of the input file parsed by a worker thread
+typedef struct _tApiLoadChunk {
+    const char* start;
+    size_t size;
+    tCSVData entries;
+    bool parsed;
+} tApiLoadChunk;
+
+// State shared by the parallel load workers
+typedef struct _tApiLoadState {
+    tApiLoadChunk* chunks;
+    int numChunks;
+    int nextChunk;
+    int applied;
+    int window;
+    bool stop;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} tApiLoadState;
+
+// Parse chunks of the file into entries until there are no more chunks to parse
+static void* api_loadWorker(void* arg) {
+    tApiLoadState* state = (tApiLoadState*) arg;
+    tApiLoadChunk* chunk;
+    tCSVReader reader;
+    const char* line;
+    int len;
+    int idx;
     
-    fclose(fin);
+    while (true) {
+        // Take the next chunk, without getting too far from the applied ones
+        pthread_mutex_lock(&(state->lock));
+        while (!state->stop && state->nextChunk < state->numChunks && state->nextChunk >= state->applied + state->window) {
+            pthread_cond_wait(&(state->changed), &(state->lock));
+        }
+        if (state->stop || state->nextChunk >= state->numChunks) {
+            pthread_mutex_unlock(&(state->lock));
+            break;
+        }
+        idx = state->nextChunk++;
+        pthread_mutex_unlock(&(state->lock));
+        
+        // Parse all the lines of the chunk
+        chunk = &(state->chunks[idx]);
+        csvReader_openBuffer(&reader, chunk->start, chunk->size);
+        while (csvReader_nextLine(&reader, &line, &len)) {
+            csv_addEntry(&(chunk->entries), line, len, NULL);
+        }
+        csvReader_close(&reader);
+        
+        // Notify the chunk is ready to be applied
+        pthread_mutex_lock(&(state->lock));
+        chunk->parsed = true;
+        pthread_cond_broadcast(&(state->changed));
+        pthread_mutex_unlock(&(state->lock));
+    }
     
-    return E_SUCCESS;
+    return NULL;
+}
+
+// Load data from a CSV file using several threads to parse it. Entries are added in the file order
+tApiError api_loadDataParallel(tApiData* data, const char* filename, int threads) {
+    tApiError error;
+    tCSVReader reader;
+    tApiLoadState state;
+    pthread_t* workers;
+    const char *pStart, *pEnd, *pLimit;
+    int numWorkers, i, j;
+    
+    // Check input data
+    assert(data != NULL);
+    assert(filename != NULL);
+    
+    // Open the input file
+    error = csvReader_open(&reader, filename);
+    if (error != E_SUCCESS) {
+        return error;
+    }
+    
+    // Only mapped files can be split. Otherwise use the serial load
+    if (threads <= 1 || !reader.mapped) {
+        csvReader_close(&reader);
+        return api_loadData(data, filename, false);
+    }
+    
+    // Cut the file in chunks at line boundaries
+    state.numChunks = (reader.size + API_LOAD_CHUNK_SIZE - 1) / API_LOAD_CHUNK_SIZE;
+    state.chunks = (tApiLoadChunk*) malloc(state.numChunks * sizeof(tApiLoadChunk));
+    if (state.chunks == NULL) {
+        csvReader_close(&reader);
+        return E_MEMORY_ERROR;
+    }
+    pStart = reader.data;
+    pLimit = reader.data + reader.size;
+    for (i = 0; i < state.numChunks && pStart < pLimit; i++) {
+        pEnd = pStart + API_LOAD_CHUNK_SIZE;
+        if (pEnd >= pLimit) {
+            pEnd = pLimit;
+        } else {
+            pEnd = memchr(pEnd, '\n', pLimit - pEnd);
+            pEnd = (pEnd == NULL) ? pLimit : pEnd + 1;
+        }
+        state.chunks[i].start = pStart;
+        state.chunks[i].size = pEnd - pStart;
+        state.chunks[i].parsed = false;
+        csv_init(&(state.chunks[i].entries));
+        pStart = pEnd;
+    }
+    state.numChunks = i;
+    state.nextChunk = 0;
+    state.applied = 0;
+    state.window = 2 * threads;
+    state.stop = false;
+    pthread_mutex_init(&(state.lock), NULL);
+    pthread_cond_init(&(state.changed), NULL);
+    
+    // Start the workers
+    workers = (pthread_t*) malloc(threads * sizeof(pthread_t));
+    numWorkers = 0;
+    if (workers != NULL) {
+        for (i = 0; i < threads; i++) {
+            if (pthread_create(&(workers[numWorkers]), NULL, api_loadWorker, &state) == 0) {
+                numWorkers++;
+            }
+        }
+    }
+    
+    // No worker could be started, use the serial load
+    if (numWorkers == 0) {
+        free(workers);
+        free(state.chunks);
+        pthread_mutex_destroy(&(state.lock));
+        pthread_cond_destroy(&(state.changed));
+        csvReader_close(&reader);
+        return api_loadData(data, filename, false);
+    }
+    
+    // Apply the chunks in the file order as soon as they are parsed
+    error = E_SUCCESS;
+    for (i = 0; i < state.numChunks && error == E_SUCCESS; i++) {
+        pthread_mutex_lock(&(state.lock));
+        while (!state.chunks[i].parsed) {
+            pthread_cond_wait(&(state.changed), &(state.lock));
+        }
+        pthread_mutex_unlock(&(state.lock));
+        
+        for (j = 0; j < csv_numEntries(state.chunks[i].entries) && error == E_SUCCESS; j++) {
+            error = api_addDataEntry(data, *csv_getEntry(state.chunks[i].entries, j));
+        }
+        csv_free(&(state.chunks[i].entries));
+        
+        pthread_mutex_lock(&(state.lock));
+        state.applied = i + 1;
+        state.stop = (error != E_SUCCESS);
+        pthread_cond_broadcast(&(state.changed));
+        pthread_mutex_unlock(&(state.lock));
+    }
+    
+    // Wait for the workers and release the chunks that were not applied
+    for (i = 0; i < numWorkers; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    for (i = 0; i < state.numChunks; i++) {
+        csv_free(&(state.chunks[i].entries));
+    }
+    
+    free(workers);
+    free(state.chunks);
+    pthread_mutex_destroy(&(state.lock));
+    pthread_cond_destroy(&(state.changed));
+    csvReader_close(&reader);
+    
+    return error;
 }
 
 // Initialize the data structure
@@ -79,11 +366,29 @@ tApiError api_initData(tApiData* data) {
     // Initialize data structures
     people_init(&(data->people));
     winegrowerList_init(&(data->winegrowers));
+    winegrowerIndex_init(&(data->winegrowerIndex));
+    vineyardIndex_init(&(data->vineyardIndex));
 
     ////////////////////////////////
     // Ex PR2 3b
     doData_init(&(data->DOs));
     ////////////////////////////////
+
+    // No snapshot loaded
+    data->snapshot = NULL;
+    data->snapshotSize = 0;
+    data->snapshotMapped = false;
+
+    // No incremental load done
+    data->loadOffset = 0;
+    data->loadChecksum = API_CHECKSUM_BASIS;
+
+    // Nothing allocated yet
+    arena_init(&(data->arena));
+    
+    // The codes and ids interned from now on are released with the data
+    symbol_acquire();
+    data->symbolsHeld = true;
     
     return E_SUCCESS;
     
@@ -92,26 +397,15 @@ tApiError api_initData(tApiData* data) {
 }
 
 // Find a Winegrower in the list of Winegrowers
-tWinegrower* apiWinegrower_find(tApiData* data  , const char* id){
+tWinegrower* apiWinegrower_find(const tApiData* data  , const char* id){
     //////////////////////////////////
     // Ex PR1 2c
     /////////////////////////////////
-   tWinegrowerList list = data->winegrowers;
-   tWinegrowerNode *pNode = NULL;
-   tWinegrowerNode *pWinegrower= NULL;
-        
-    // Point the first element
-    pNode = list.first;
-    
-    while(pNode != NULL && pWinegrower == NULL) {
-        // Compare current node with given id
-        if (strcmp(pNode->winegrower.id, id) == 0) {
-            pWinegrower = pNode;
-        }
-        pNode = pNode->next;
-    }
+    assert(data != NULL);
+    assert(id != NULL);
     
-    return &(pWinegrower->winegrower);        
+    // Search the winegrower in the index instead of walking the list
+    return winegrowerIndex_find(&(data->winegrowerIndex), &(data->winegrowers), id);
 
 }
 
@@ -119,15 +413,18 @@ tApiError api_addWinegrower(tApiData* data, tCSVEntry entry) {
     //////////////////////////////////
     // Ex PR1 2d
     /////////////////////////////////
+    char winegrowerId[WINEGROWERS_ID_LENGTH + 1];
+    char vineyardCode[MAX_VINEYARD_CODE_LENGTH + 1];
     tWinegrower winegrower;
     tVineyardplot vineyardplot;
     tWinegrower *pWinegrower;
+    tArena* previous;
     
     // Check input data structure
     assert(data != NULL);
     
     // Check the entry type
-    if (strcmp(csv_getType(&entry), "WINEGROWER") != 0) {
+    if (csv_getTypeId(&entry) != CSV_TYPE_WINEGROWER) {
         return E_INVALID_ENTRY_TYPE;
     }
     
@@ -136,32 +433,34 @@ tApiError api_addWinegrower(tApiData* data, tCSVEntry entry) {
         return E_INVALID_ENTRY_FORMAT;
     }
     
-    // Parse the entry
-     winegrower_parse(&winegrower, &vineyardplot, entry);
-
-        
-    // Check vineyardplot code
-    if (!check_vineyard_code(vineyardplot.code)) {
-        // Release temporal data
-        winegrower_free(&winegrower);
-        vineyardplot_free(&vineyardplot);
+    // Check vineyardplot code before parsing, so a wrong row does not intern any symbol
+    csv_getAsString(entry, 3, vineyardCode, MAX_VINEYARD_CODE_LENGTH + 1);
+    if (!check_vineyard_code(vineyardCode)) {
         return E_INVALID_VINEYARD_CODE;
     }
     
     // Check if winegrower exists
-    pWinegrower = apiWinegrower_find(data, winegrower.id);
+    csv_getAsString(entry, 2, winegrowerId, WINEGROWERS_ID_LENGTH + 1);
+    pWinegrower = apiWinegrower_find(data, winegrowerId);
+    
+    // Parse the entry. A new winegrower is parsed in the arena, to be stored without copying it again
+    previous = arena_enter((pWinegrower == NULL) ? &(data->arena) : NULL);
+    winegrower_parse(&winegrower, &vineyardplot, entry);
+    arena_leave(previous);
+    
+    // The structures grow in the arena
+    previous = arena_enter(&(data->arena));
+    
     if (pWinegrower == NULL) {
-        // Add the winegrower
-        winegrowerList_insert(&data->winegrowers, winegrower);
-        pWinegrower = apiWinegrower_find(data, winegrower.id);
+        // Add the winegrower, that takes the parsed document
+        pWinegrower = winegrowerIndex_insertMove(&(data->winegrowerIndex), &(data->winegrowers), &winegrower);
     }
     assert(pWinegrower != NULL);
     
-    // Check if vineyardplot exists
-    if (vineyardplotData_find(pWinegrower->vineyardplots, vineyardplot.code) == -1) {
-        // Add the vineyardplot
-        vineyardplotData_add(&(pWinegrower->vineyardplots), vineyardplot);
-    }
+    // Add the vineyardplot if it does not exist
+    vineyardIndex_addVineyardplotMove(&(data->vineyardIndex), pWinegrower, &vineyardplot);
+    
+    arena_leave(previous);
  
     // Release temporal data
     winegrower_free(&winegrower);
@@ -176,15 +475,16 @@ tApiError api_addVineyardplot(tApiData* data, tCSVEntry entry) {
     // Ex PR1 2e
     /////////////////////////////////
     char winegrowerId[WINEGROWERS_ID_LENGTH + 1];
-
+    char vineyardCode[MAX_VINEYARD_CODE_LENGTH + 1];
     tVineyardplot vineyardplot;
     tWinegrower *pWinegrower;
+    tArena* previous;
     
     // Check input data structure
     assert(data != NULL);
     
     // Check the entry type
-    if (strcmp(csv_getType(&entry), "VINEYARD_PLOT") != 0) {
+    if (csv_getTypeId(&entry) != CSV_TYPE_VINEYARD_PLOT) {
         return E_INVALID_ENTRY_TYPE;
     }
     
@@ -193,35 +493,31 @@ tApiError api_addVineyardplot(tApiData* data, tCSVEntry entry) {
         return E_INVALID_ENTRY_FORMAT;
     }
     
-    
-    // Parse the entry
-    
+    // The row is checked before parsing, so a wrong row does not intern any symbol
     csv_getAsString(entry, 0, winegrowerId, WINEGROWERS_ID_LENGTH + 1);        
-
-    vineyardplot_parse( &vineyardplot, entry);
-
+    csv_getAsString(entry, 1, vineyardCode, MAX_VINEYARD_CODE_LENGTH + 1);
         
     // Check vineyardplot code
-    if (!check_vineyard_code(vineyardplot.code)) {
-        vineyardplot_free(&vineyardplot);
+    if (!check_vineyard_code(vineyardCode)) {
         return E_INVALID_VINEYARD_CODE;
     }
     
     // Check if winegrower exists
     pWinegrower = apiWinegrower_find(data, winegrowerId);
     if (pWinegrower == NULL) {
-        vineyardplot_free(&vineyardplot);
         return E_WINEGROWER_NOT_FOUND;
     }
     
     // Check if vineyardplot exists
-    if (vineyardplotData_find(pWinegrower->vineyardplots, vineyardplot.code) == -1) {
-        // Add the vineyardplot
-        vineyardplotData_add(&(pWinegrower->vineyardplots), vineyardplot);
-    } else {
-        vineyardplot_free(&vineyardplot);
+    if (vineyardplotData_find(pWinegrower->vineyardplots, vineyardCode) != -1) {
         return     E_DUPLICATED_VINEYARD;
     }
+    
+    // Parse the entry and add the vineyardplot without copying it. The vineyardplots grow in the arena
+    vineyardplot_parse( &vineyardplot, entry);
+    previous = arena_enter(&(data->arena));
+    vineyardIndex_addVineyardplotMove(&(data->vineyardIndex), pWinegrower, &vineyardplot);
+    arena_leave(previous);
  
     // Release temporal data
     vineyardplot_free(&vineyardplot);
@@ -234,20 +530,17 @@ tApiError api_addWeighing(tApiData* data, tCSVEntry entry) {
     //////////////////////////////////
     // Ex PR3 EX 4d
     /////////////////////////////////
+    char vineyardCode[MAX_VINEYARD_CODE_LENGTH + 1];
     tWeighing weighing;
-    tWinegrower *pWinegrower;
-//    tVineyardplot vineyardplot;
-//    tWinegrower *pWinegrower;
-    int i,j;
+    tVineyardplot *pVineyardplot;
+    tApiError error;
+    tArena* previous;
     
     // Check input data structure
     assert(data!=NULL);
     
-    // Initialize an empty weighing to avoid possible memory errors with weighing_parse
-    //do_initEmpty(&DO);
-    
     // Check the entry type
-    if (strcmp(csv_getType(&entry), "WEIGHING") != 0) {
+    if (csv_getTypeId(&entry) != CSV_TYPE_WEIGHING) {
         return E_INVALID_ENTRY_TYPE;
     }
     
@@ -256,22 +549,37 @@ tApiError api_addWeighing(tApiData* data, tCSVEntry entry) {
         return E_INVALID_ENTRY_FORMAT;
     }
     
+    // Check vineyardplot code before parsing, so a wrong row does not intern any symbol
+    csv_getAsString(entry, 4, vineyardCode, MAX_VINEYARD_CODE_LENGTH + 1);
+    if (!check_vineyard_code(vineyardCode)) {
+        return E_INVALID_VINEYARD_CODE;
+    }
+    
+    // Search the vineyardplot in the index of all the vineyardplots
+    pVineyardplot = vineyardIndex_find(&(data->vineyardIndex), vineyardCode, NULL);
+    if (pVineyardplot == NULL) {
+        return E_VINEYARD_NOT_FOUND;
+    }
+    
     // Parse the entry
     weighing_parse(&weighing, entry);
-
-
-
-    //vineyardplotData_find  int vineyardplotData_find(tVineyardplotData data, const char* code);
     
-    //tWeighingNode* weighingList_findNode(tWeighingList list, const char* code, tDate harvestDay);
-
-    //weighingList_add  tApiError weighingList_add(tWeighingList* list, tWeighing weighing);
+    // Add the weighing to the vineyardplot. The copy is stored in the arena
+    previous = arena_enter(&(data->arena));
+    error = weighingList_add(&(pVineyardplot->weights), weighing);
+    arena_leave(previous);
+    
+    // Release temporal data
+    weighing_free(&weighing);
+    
+    return error;
 }
 
 // Add a new DO
 tApiError api_addDO(tApiData* data, tCSVEntry entry) {
     tDO DO;
     tApiError error;
+    tArena* previous;
     
     // Check input data structure
     assert(data != NULL);
@@ -280,7 +588,7 @@ tApiError api_addDO(tApiData* data, tCSVEntry entry) {
     do_initEmpty(&DO);
     
     // Check the entry type
-    if (strcmp(csv_getType(&entry), "DO") != 0) {
+    if (csv_getTypeId(&entry) != CSV_TYPE_DO) {
         return E_INVALID_ENTRY_TYPE;
     }
     
@@ -289,35 +597,40 @@ tApiError api_addDO(tApiData* data, tCSVEntry entry) {
         return E_INVALID_ENTRY_FORMAT;
     }
     
-    // Parse the entry
-    do_parse(&DO, entry);
-    
-    // Add to the structure
-    if (doData_find(data->DOs, DO.code) == NULL) {
-        error = doData_add(&(data->DOs), DO);
-        
-        if (error != E_SUCCESS) {
-            do_free(&DO);
-            return error;
-        }
-    } else {
-        do_free(&DO);
+    // Check the code, the first field, and if the DO exists
+    if (!do_checkCode(entry.fields[0])) {
+        return E_INVALID_ENTRY_FORMAT;
+    }
+    if (doData_find_ptr(&(data->DOs), entry.fields[0]) != NULL) {
         return E_DUPLICATED_DO;
     }
     
-    // Release temporal data
+    // Parse the entry in the arena, and add it to the structure without copying it again
+    previous = arena_enter(&(data->arena));
+    do_parse(&DO, entry);
+    error = doData_addMove(&(data->DOs), &DO);
+    arena_leave(previous);
+    
+    // Release temporal data, if the DO was not added
     do_free(&DO);
     
-    return E_SUCCESS;
+    return error;
 }
 
 
 // Get the number of people registered on the application
 int api_peopleCount(tApiData data) {
+    return api_peopleCount_ptr(&data);
+}
+
+// Get the number of people registered on the application, without copying the data
+int api_peopleCount_ptr(const tApiData* data) {
     //////////////////////////////////
     // Ex PR1 2f
     /////////////////////////////////
-    return people_len(data.people);
+    assert(data != NULL);
+    
+    return people_len_ptr(&(data->people));
     /////////////////////////////////
     //return -1;
 }
@@ -325,29 +638,50 @@ int api_peopleCount(tApiData data) {
 
 // Get the number of winegrowers registered on the application
 int api_winegrowersCount(tApiData data) {
+    return api_winegrowersCount_ptr(&data);
+}
+
+// Get the number of winegrowers registered on the application, without copying the data
+int api_winegrowersCount_ptr(const tApiData* data) {
     //////////////////////////////////
     // Ex PR1 2f
     /////////////////////////////////
-    return winegrowerList_len(data.winegrowers);    
+    assert(data != NULL);
+    
+    return winegrowerList_len(data->winegrowers);    
     /////////////////////////////////
     //return -1;
 }
 
 // Get the number of vineyardplots in all winegrowers registered on the application
 int api_vineyardplotCount(tApiData data) {
+    return api_vineyardplotCount_ptr(&data);
+}
+
+// Get the number of vineyardplots in all winegrowers registered on the application, without copying the data
+int api_vineyardplotCount_ptr(const tApiData* data) {
     //////////////////////////////////
     // Ex PR1 2f
     /////////////////////////////////
-    return winegrowerList_vineyardplots_total(data.winegrowers);    
+    assert(data != NULL);
+    
+    return winegrowerList_vineyardplots_total(data->winegrowers);    
     /////////////////////////////////
     //return -1;
 }
 
 // Get the number of DOs redistered on the application
 int api_DOCount(tApiData data) {
+    return api_DOCount_ptr(&data);
+}
+
+// Get the number of DOs registered on the application, without copying the data
+int api_DOCount_ptr(const tApiData* data) {
     //////////////////////////////////
     // Ex PR2 3e
-    return doData_len(data.DOs);
+    assert(data != NULL);
+    
+    return doData_len_ptr(&(data->DOs));
     /////////////////////////////////
     //return -1;
 }
@@ -357,101 +691,520 @@ tApiError api_freeData(tApiData* data) {
     //////////////////////////////////
     // Ex PR1 2g
     /////////////////////////////////
-    people_free(&(data->people));
-    winegrowerList_free(&(data->winegrowers));
+    // All the people, winegrowers and DOs, with their indexes, are in the arena.
+    // Release it at once instead of walking the structures
+    arena_release(&(data->arena));
+
+    people_init(&(data->people));
+    winegrowerIndex_init(&(data->winegrowerIndex));
+    vineyardIndex_init(&(data->vineyardIndex));
+    winegrowerList_init(&(data->winegrowers));
     /////////////////////////////////
     
     ////////////////////////////////
     // Ex PR2 3d
-    doData_free(&(data->DOs));
+    doData_init(&(data->DOs));
     ////////////////////////////////
+
+    snapshot_release(data);
+    
+    // Nothing points to the symbols interned for the data anymore
+    if (data->symbolsHeld) {
+        data->symbolsHeld = false;
+        symbol_release();
+    }
     
     return E_SUCCESS;
     //return E_NOT_IMPLEMENTED;
 }
 
+// Get the number of bytes used and mapped by the arena of the data
+void api_getArenaUsage(tApiData data, size_t* used, size_t* mapped) {
+    api_getArenaUsage_ptr(&data, used, mapped);
+}
+
+// Get the number of bytes used and mapped by the arena of the data, without copying the data
+void api_getArenaUsage_ptr(const tApiData* data, size_t* used, size_t* mapped) {
+    // Check input data
+    assert(data != NULL);
+
+    // Check output data
+    assert(used != NULL);
+    assert(mapped != NULL);
+
+    *used = arena_used(&(data->arena));
+    *mapped = arena_mapped(&(data->arena));
+}
+
+// Save all the data to a binary snapshot file
+tApiError api_saveSnapshot(tApiData* data, const char* filename) {
+    // Check input data
+    assert(data != NULL);
+    assert(filename != NULL);
+
+    return snapshot_save(data, filename);
+}
+
+// Replace the data with the content of a binary snapshot file
+tApiError api_loadSnapshot(tApiData* data, const char* filename, bool readOnly) {
+    tApiError error;
+    tArena* previous;
+
+    // Check input data
+    assert(data != NULL);
+    assert(filename != NULL);
+
+    // Remove previous data
+    error = api_freeData(data);
+    if (error != E_SUCCESS) {
+        return error;
+    }
+    error = api_initData(data);
+    if (error != E_SUCCESS) {
+        return error;
+    }
+
+    // The restored data is allocated in the arena
+    previous = arena_enter(&(data->arena));
+    error = snapshot_load(data, filename, readOnly);
+    arena_leave(previous);
+    if (error != E_SUCCESS) {
+        // Do not keep a partially restored data
+        api_freeData(data);
+        api_initData(data);
+    }
+
+    return error;
+}
+
+
+// Add a new person
+tApiError api_addPerson(tApiData* data, tCSVEntry entry) {
+    tPerson person;
+    tArena* previous;
+    
+    assert(data != NULL);
+    
+    // Check the entry type
+    if (csv_getTypeId(&entry) != CSV_TYPE_PERSON) {
+        return E_INVALID_ENTRY_TYPE;
+    }
+    
+    // Initialize the person object
+    person_init(&person);
+
+    // Check the number of fields
+    if(csv_numFields(entry) != 8) {
+        return E_INVALID_ENTRY_FORMAT;
+    }
+    // Check if this person already exists. The document is the first field
+    if (people_find_ptr(&(data->people), entry.fields[0]) >= 0) {
+        return E_DUPLICATED_PERSON;
+    }
+    
+    // Parse the data in the arena, and add the new person without copying it again.
+    // It is already known that it does not exist
+    previous = arena_enter(&(data->arena));
+    person_parse(&person, entry);
+    people_appendMove(&(data->people), &person);
+    arena_leave(previous);
+    
+    return E_SUCCESS;
+}
+
+// Handler of each type of entry, indexed by the type classified by the CSV parser
+static tApiError (*const api_entryHandlers[CSV_NUM_TYPES])(tApiData* data, tCSVEntry entry) = {
+    [CSV_TYPE_UNKNOWN] = NULL,
+    [CSV_TYPE_PERSON] = api_addPerson,
+    [CSV_TYPE_WINEGROWER] = api_addWinegrower,
+    [CSV_TYPE_VINEYARD_PLOT] = api_addVineyardplot,
+    [CSV_TYPE_DO] = api_addDO,
+    [CSV_TYPE_WEIGHING] = api_addWeighing,
+};
 
 // Add a new entry
 tApiError api_addDataEntry(tApiData* data, tCSVEntry entry) { 
     //////////////////////////////////
     // Ex PR1 2h
     /////////////////////////////////
-    tPerson person;
+    tCSVEntryType type;
         
     assert(data != NULL);
 
-    if (strcmp(csv_getType(&entry), "PERSON") == 0) {
-        // Add person
-        // Initialize the person object
-        person_init(&person);
+    // Dispatch the entry using the type classified when it was parsed
+    type = csv_getTypeId(&entry);
+    if (api_entryHandlers[type] == NULL) {
+        return E_INVALID_ENTRY_TYPE;
+    }
+    
+    return api_entryHandlers[type](data, entry);
+    /////////////////////////////////
+    //return E_NOT_IMPLEMENTED;
+}
+
+// Groups of a batch of entries, in the order they are applied
+typedef enum _tApiBatchGroup {
+    BATCH_PERSON = 0,
+    BATCH_DO,
+    BATCH_WINEGROWER,
+    BATCH_VINEYARD_PLOT,
+    BATCH_WEIGHING,
+    BATCH_NUM_GROUPS,
+    BATCH_NONE
+} tApiBatchGroup;
 
-        // Check the number of fields
-        if(csv_numFields(entry) != 8) {
-            return E_INVALID_ENTRY_FORMAT;
+// Sort key of a row in a batch of entries
+typedef struct _tApiBatchKey {
+    const char* key;
+    int row;
+    void* target;
+} tApiBatchKey;
+
+// Compare two batch keys by key and then by row, so rows with the same key keep the input order
+static int api_cmpBatchKey(const void* a, const void* b) {
+    const tApiBatchKey* key1 = (const tApiBatchKey*) a;
+    const tApiBatchKey* key2 = (const tApiBatchKey*) b;
+    int cmp;
+    
+    cmp = strcmp(key1->key, key2->key);
+    if (cmp != 0) {
+        return cmp;
+    }
+    return (key1->row > key2->row) - (key1->row < key2->row);
+}
+
+// Check a sorted group of PERSON rows against the registered people and add the new ones
+static void api_addPeopleBatch(tApiData* data, tCSVData* entries, tApiBatchKey* rows, int count, tApiBatchGroup* groups, tApiError* results) {
+    const char* prev = NULL;
+    tPerson person;
+    tArena* previous;
+    int i;
+    
+    // Registered documents are found through the people hash index. Repeated rows are next to each other
+    for (i = 0; i < count; i++) {
+        if (people_find_ptr(&(data->people), rows[i].key) >= 0 || (prev != NULL && strcmp(prev, rows[i].key) == 0)) {
+            results[rows[i].row] = E_DUPLICATED_PERSON;
+        } else {
+            results[rows[i].row] = E_SUCCESS;
         }
-        // Parse the data
-        person_parse(&person, entry);
+        prev = rows[i].key;
+    }
+    
+    // Add the new people in the input order, parsed straight into the arena
+    person_init(&person);
+    previous = arena_enter(&(data->arena));
+    for (i = 0; i < csv_numEntries(*entries); i++) {
+        if (groups[i] == BATCH_PERSON && results[i] == E_SUCCESS) {
+            person_parse(&person, *csv_getEntry(*entries, i));
+            people_appendMove(&(data->people), &person);
+        }
+    }
+    arena_leave(previous);
+}
+
+// Check a sorted group of DO rows against the registered DOs and add the new ones
+static void api_addDOsBatch(tApiData* data, tCSVData* entries, tApiBatchKey* rows, int count, tApiBatchGroup* groups, tApiError* results) {
+    const char* prev = NULL;
+    tDO DO;
+    tArena* previous;
+    int i;
+    
+    // Registered codes are found through the DO hash index. Repeated rows are next to each other
+    for (i = 0; i < count; i++) {
+        if (!do_checkCode(rows[i].key)) {
+            results[rows[i].row] = E_INVALID_ENTRY_FORMAT;
+        } else if (doData_findPos_ptr(&(data->DOs), rows[i].key) != -1 || (prev != NULL && strcmp(prev, rows[i].key) == 0)) {
+            results[rows[i].row] = E_DUPLICATED_DO;
+        } else {
+            results[rows[i].row] = E_SUCCESS;
+        }
+        prev = rows[i].key;
+    }
+    
+    // Add the new DOs in the input order, parsed straight into the arena
+    previous = arena_enter(&(data->arena));
+    for (i = 0; i < csv_numEntries(*entries); i++) {
+        if (groups[i] == BATCH_DO && results[i] == E_SUCCESS) {
+            do_initEmpty(&DO);
+            do_parse(&DO, *csv_getEntry(*entries, i));
+            results[i] = doData_addMove(&(data->DOs), &DO);
+            do_free(&DO);
+        }
+    }
+    arena_leave(previous);
+}
+
+// Merge a group of WINEGROWER rows sorted by id with the winegrowers list in a single ordered pass
+static void api_addWinegrowersBatch(tApiData* data, tCSVData* entries, tApiBatchKey* rows, int count, tApiError* results) {
+    char winegrowerId[WINEGROWERS_ID_LENGTH + 1];
+    char vineyardCode[MAX_VINEYARD_CODE_LENGTH + 1];
+    tWinegrowerNode *pNode, *pPrev, *pNew;
+    tWinegrower winegrower;
+    tVineyardplot vineyardplot;
+    tCSVEntry* entry;
+    tArena* previous;
+    bool exists;
+    int i;
+    
+    pPrev = NULL;
+    pNode = data->winegrowers.first;
+    for (i = 0; i < count; i++) {
+        entry = csv_getEntry(*entries, rows[i].row);
+        csv_getAsString(*entry, 2, winegrowerId, WINEGROWERS_ID_LENGTH + 1);
         
-        // Check if this person already exists
-        if (people_find(data->people, person.document) >= 0) {
-            // Release person object
-            person_free(&person);
-            return E_DUPLICATED_PERSON;
+        // Check vineyardplot code before parsing, so a wrong row does not intern any symbol
+        csv_getAsString(*entry, 3, vineyardCode, MAX_VINEYARD_CODE_LENGTH + 1);
+        if (!check_vineyard_code(vineyardCode)) {
+            results[rows[i].row] = E_INVALID_VINEYARD_CODE;
+            continue;
         }
         
-        // Add the new person
-        people_add(&(data->people), person);
+        // Advance in the list up to the position of this winegrower
+        while (pNode != NULL && strcmp(pNode->winegrower.id, winegrowerId) < 0) {
+            pPrev = pNode;
+            pNode = pNode->next;
+        }
+        exists = pNode != NULL && strcmp(pNode->winegrower.id, winegrowerId) == 0;
         
-        // Release person object
-        person_free(&person);
+        // Parse the entry. A new winegrower is parsed in the arena, to be stored without copying it again
+        previous = arena_enter(exists ? NULL : &(data->arena));
+        winegrower_parse(&winegrower, &vineyardplot, *entry);
+        arena_leave(previous);
         
- 
-    } else if (strcmp(csv_getType(&entry), "WINEGROWER") == 0) {
-        // Add winegrower
-        return api_addWinegrower(data, entry);        
-    } else if (strcmp(csv_getType(&entry), "VINEYARD_PLOT") == 0) {
-        // Add vineyard plot
-        return api_addVineyardplot(data, entry);
-    } 
-    //////////////////////////////////
-    // Ex PR2 3c
-    /////////////////////////////////
-    else if (strcmp(csv_getType(&entry), "DO") == 0) {
-        // Add DO
-        return api_addDO(data, entry);
+        // The structures grow in the arena
+        previous = arena_enter(&(data->arena));
+        
+        // Add the winegrower before the current node if it does not exist. The node takes the parsed document
+        if (!exists) {
+            pNew = nodePool_newWinegrowerNode();
+            assert(pNew != NULL);
+            pNew->winegrower = winegrower;
+            winegrower.document = NULL;
+            vineyardplotData_init(&(winegrower.vineyardplots));
+            pNew->next = pNode;
+            if (pPrev == NULL) {
+                data->winegrowers.first = pNew;
+            } else {
+                pPrev->next = pNew;
+            }
+            data->winegrowers.count++;
+            winegrowerIndex_add(&(data->winegrowerIndex), pNew);
+            pNode = pNew;
+        }
+        
+        // Add the vineyardplot if it does not exist
+        vineyardIndex_addVineyardplotMove(&(data->vineyardIndex), &(pNode->winegrower), &vineyardplot);
+        arena_leave(previous);
+        results[rows[i].row] = E_SUCCESS;
+        
+        // Release temporal data
+        winegrower_free(&winegrower);
+        vineyardplot_free(&vineyardplot);
     }
-    //////////////////////////////////
-    // PR3 EX 4e
-    /////////////////////////////////
-    else if(strcmp(csv_getType(&entry), "WEIGHING") == 0) {
-        // Add WEIGHING
-        return api_addWeighing(data, entry);
+}
+
+// Merge a group of VINEYARD_PLOT rows sorted by winegrower id with the winegrowers list in a single ordered pass
+static void api_addVineyardplotsBatch(tApiData* data, tCSVData* entries, tApiBatchKey* rows, int count, tApiError* results) {
+    char winegrowerId[WINEGROWERS_ID_LENGTH + 1];
+    char vineyardCode[MAX_VINEYARD_CODE_LENGTH + 1];
+    tWinegrowerNode *pNode;
+    tVineyardplot vineyardplot;
+    tCSVEntry* entry;
+    tArena* previous;
+    int i;
+    
+    pNode = data->winegrowers.first;
+    for (i = 0; i < count; i++) {
+        // The row is checked before parsing, so a wrong row does not intern any symbol
+        entry = csv_getEntry(*entries, rows[i].row);
+        csv_getAsString(*entry, 0, winegrowerId, WINEGROWERS_ID_LENGTH + 1);
+        csv_getAsString(*entry, 1, vineyardCode, MAX_VINEYARD_CODE_LENGTH + 1);
+        
+        // Advance in the list up to the position of this winegrower
+        while (pNode != NULL && strcmp(pNode->winegrower.id, winegrowerId) < 0) {
+            pNode = pNode->next;
+        }
         
+        if (!check_vineyard_code(vineyardCode)) {
+            results[rows[i].row] = E_INVALID_VINEYARD_CODE;
+        } else if (pNode == NULL || strcmp(pNode->winegrower.id, winegrowerId) != 0) {
+            results[rows[i].row] = E_WINEGROWER_NOT_FOUND;
+        } else if (vineyardplotData_find(pNode->winegrower.vineyardplots, vineyardCode) != -1) {
+            results[rows[i].row] = E_DUPLICATED_VINEYARD;
+        } else {
+            vineyardplot_parse(&vineyardplot, *entry);
+            previous = arena_enter(&(data->arena));
+            vineyardIndex_addVineyardplotMove(&(data->vineyardIndex), &(pNode->winegrower), &vineyardplot);
+            arena_leave(previous);
+            results[rows[i].row] = E_SUCCESS;
+            
+            // Release temporal data
+            vineyardplot_free(&vineyardplot);
+        }
     }
+}
 
-    /////////////////////////////////
-    else {
-        return E_INVALID_ENTRY_TYPE;
+// Add a group of WEIGHING rows sorted by vineyard code to their vineyardplots, found through the vineyard index
+static void api_addWeighingsBatch(tApiData* data, tCSVData* entries, tApiBatchKey* rows, int count, tApiError* results) {
+    char vineyardCode[MAX_VINEYARD_CODE_LENGTH + 1];
+    tVineyardplot* plot;
+    tWeighing weighing;
+    tCSVEntry* entry;
+    tArena* previous;
+    int i;
+    
+    plot = NULL;
+    for (i = 0; i < count; i++) {
+        entry = csv_getEntry(*entries, rows[i].row);
+        csv_getAsString(*entry, 4, vineyardCode, MAX_VINEYARD_CODE_LENGTH + 1);
+        
+        // Rows of the same vineyardplot are next to each other, so it is only searched when the code changes
+        if (i == 0 || strcmp(rows[i - 1].key, rows[i].key) != 0) {
+            plot = check_vineyard_code(vineyardCode) ? vineyardIndex_find(&(data->vineyardIndex), vineyardCode, NULL) : NULL;
+        }
+        
+        if (!check_vineyard_code(vineyardCode)) {
+            results[rows[i].row] = E_INVALID_VINEYARD_CODE;
+        } else if (plot == NULL) {
+            results[rows[i].row] = E_VINEYARD_NOT_FOUND;
+        } else {
+            // Only the rows that are added are parsed, so a wrong row does not intern any symbol
+            weighing_parse(&weighing, *entry);
+            previous = arena_enter(&(data->arena));
+            results[rows[i].row] = weighingList_add(&(plot->weights), weighing);
+            arena_leave(previous);
+            
+            // Release temporal data
+            weighing_free(&weighing);
+        }
+    }
+}
+
+// Add a batch of entries
+tApiError api_addDataEntries(tApiData* data, tCSVData* entries, tApiError* results) {
+    tApiBatchKey* rows[BATCH_NUM_GROUPS];
+    int counts[BATCH_NUM_GROUPS];
+    tApiBatchGroup* groups;
+    tCSVEntry* entry;
+    int numEntries, i;
+    
+    assert(data != NULL);
+    assert(entries != NULL);
+    assert(results != NULL);
+    
+    numEntries = csv_numEntries(*entries);
+    groups = (tApiBatchGroup*) malloc((numEntries + 1) * sizeof(tApiBatchGroup));
+    if (groups == NULL) {
+        return E_MEMORY_ERROR;
+    }
+    for (i = 0; i < BATCH_NUM_GROUPS; i++) {
+        rows[i] = (tApiBatchKey*) malloc((numEntries + 1) * sizeof(tApiBatchKey));
+        counts[i] = 0;
+        if (rows[i] == NULL) {
+            // Release the groups allocated before
+            while (--i >= 0) {
+                free(rows[i]);
+            }
+            free(groups);
+            return E_MEMORY_ERROR;
+        }
+    }
+    
+    // Group the rows by type, checking the type and the number of fields as api_addDataEntry
+    for (i = 0; i < numEntries; i++) {
+        entry = csv_getEntry(*entries, i);
+        groups[i] = BATCH_NONE;
+        results[i] = E_SUCCESS;
+        
+        switch (csv_getTypeId(entry)) {
+            case CSV_TYPE_PERSON:
+                groups[i] = (csv_numFields(*entry) == 8) ? BATCH_PERSON : BATCH_NONE;
+                break;
+            case CSV_TYPE_WINEGROWER:
+                groups[i] = (csv_numFields(*entry) == NUM_FIELDS_WINEGROWER) ? BATCH_WINEGROWER : BATCH_NONE;
+                break;
+            case CSV_TYPE_VINEYARD_PLOT:
+                groups[i] = (csv_numFields(*entry) == NUM_FIELDS_VINEYARD_PLOT) ? BATCH_VINEYARD_PLOT : BATCH_NONE;
+                break;
+            case CSV_TYPE_DO:
+                groups[i] = (csv_numFields(*entry) == NUM_FIELDS_DO) ? BATCH_DO : BATCH_NONE;
+                break;
+            case CSV_TYPE_WEIGHING:
+                groups[i] = (csv_numFields(*entry) == NUM_FIELDS_WEIGHING) ? BATCH_WEIGHING : BATCH_NONE;
+                break;
+            default:
+                results[i] = E_INVALID_ENTRY_TYPE;
+                continue;
+        }
+        
+        if (groups[i] == BATCH_NONE) {
+            results[i] = E_INVALID_ENTRY_FORMAT;
+            continue;
+        }
+        
+        // Key of the row: person document, DO code, winegrower id or vineyard code
+        rows[groups[i]][counts[groups[i]]].row = i;
+        rows[groups[i]][counts[groups[i]]].target = NULL;
+        switch (groups[i]) {
+            case BATCH_WINEGROWER:
+                rows[groups[i]][counts[groups[i]]].key = entry->fields[2];
+                break;
+            case BATCH_WEIGHING:
+                rows[groups[i]][counts[groups[i]]].key = entry->fields[4];
+                break;
+            default:
+                rows[groups[i]][counts[groups[i]]].key = entry->fields[0];
+                break;
+        }
+        counts[groups[i]]++;
+    }
+    
+    // Sort each group by key
+    for (i = 0; i < BATCH_NUM_GROUPS; i++) {
+        qsort(rows[i], counts[i], sizeof(tApiBatchKey), api_cmpBatchKey);
+    }
+    
+    // Merge each group with the current data
+    api_addPeopleBatch(data, entries, rows[BATCH_PERSON], counts[BATCH_PERSON], groups, results);
+    api_addDOsBatch(data, entries, rows[BATCH_DO], counts[BATCH_DO], groups, results);
+    api_addWinegrowersBatch(data, entries, rows[BATCH_WINEGROWER], counts[BATCH_WINEGROWER], results);
+    api_addVineyardplotsBatch(data, entries, rows[BATCH_VINEYARD_PLOT], counts[BATCH_VINEYARD_PLOT], results);
+    api_addWeighingsBatch(data, entries, rows[BATCH_WEIGHING], counts[BATCH_WEIGHING], results);
+    
+    for (i = 0; i < BATCH_NUM_GROUPS; i++) {
+        free(rows[i]);
+    }
+    free(groups);
+    
+    // Return the error of the first row that failed
+    for (i = 0; i < numEntries; i++) {
+        if (results[i] != E_SUCCESS) {
+            return results[i];
+        }
     }
     
     return E_SUCCESS;
-    /////////////////////////////////
-    //return E_NOT_IMPLEMENTED;
 }
 
 // Get winegrower data
 tApiError api_getWinegrower(tApiData data, const char *id, tCSVEntry *entry) {
+    return api_getWinegrower_ptr(&data, id, entry);
+}
+
+// Get winegrower data, without copying the data
+tApiError api_getWinegrower_ptr(const tApiData* data, const char *id, tCSVEntry *entry) {
     //////////////////////////////////
     // Ex PR1 3a
     /////////////////////////////////
     char buffer[2048];
     tWinegrower* winegrower = NULL;
         
+    assert(data != NULL);
     assert(id != NULL);
     assert(entry != NULL);
     
     // Search winegrower
-    winegrower = apiWinegrower_find(&data, id);
+    winegrower = apiWinegrower_find(data, id);
     
     if (winegrower == NULL) {
         return E_WINEGROWER_NOT_FOUND;
@@ -471,13 +1224,18 @@ tApiError api_getWinegrower(tApiData data, const char *id, tCSVEntry *entry) {
 
 // Get vineyardplot
 tApiError api_getVineyardplot(tApiData data, const char* vineyardCode, tCSVEntry *entry) {
+    return api_getVineyardplot_ptr(&data, vineyardCode, entry);
+}
+
+// Get vineyardplot, without copying the data
+tApiError api_getVineyardplot_ptr(const tApiData* data, const char* vineyardCode, tCSVEntry *entry) {
     //////////////////////////////////
     // Ex PR1 3b
     /////////////////////////////////
     char buffer[2048];    
-    tWinegrower *pWinegrower= NULL; 
-    int idx;
+    tVineyardplot *pVineyardplot = NULL; 
 
+    assert(data != NULL);
     assert(vineyardCode != NULL);
     assert(entry != NULL);
     
@@ -486,20 +1244,18 @@ tApiError api_getVineyardplot(tApiData data, const char* vineyardCode, tCSVEntry
         return E_INVALID_VINEYARD_CODE;
     }
     
-    pWinegrower = winegrowerList_containsVineyardplot(data.winegrowers, vineyardCode);
+    // Search the vineyardplot in the index of all the vineyardplots
+    pVineyardplot = vineyardIndex_find(&(data->vineyardIndex), vineyardCode, NULL);
         
-    if (pWinegrower == NULL) {
+    if (pVineyardplot == NULL) {
         return E_VINEYARD_NOT_FOUND;
     }
-    
-   // Search winegrower that contains the vineyard
-   idx = vineyardplotData_find(pWinegrower->vineyardplots, vineyardCode);
 
     // Print data in the buffer
     sprintf(buffer, "%s;%s;%.2f", 
-        pWinegrower->vineyardplots.elems[idx].code,
-        pWinegrower->vineyardplots.elems[idx].doCode,
-        pWinegrower->vineyardplots.elems[idx].weight
+        pVineyardplot->code,
+        pVineyardplot->doCode,
+        pVineyardplot->weight
     );
     // Initialize the output structure
     csv_initEntry(entry);
@@ -515,15 +1271,22 @@ tApiError api_getVineyardplot(tApiData data, const char* vineyardCode, tCSVEntry
 
 // Get registered winegrower
 tApiError api_getWinegrowers(tApiData data, tCSVData *winegrowers) {
+    return api_getWinegrowers_ptr(&data, winegrowers);
+}
+
+// Get registered winegrower, without copying the data
+tApiError api_getWinegrowers_ptr(const tApiData* data, tCSVData *winegrowers) {
     //////////////////////////////////
     // Ex PR1 3c
     /////////////////////////////////
     char buffer[2048];
     tWinegrowerNode *pNode = NULL;
     
+    assert(data != NULL);
+    
     csv_init(winegrowers);
         
-    pNode = data.winegrowers.first;
+    pNode = data->winegrowers.first;
     while(pNode != NULL) {
         sprintf(buffer, "%s;%s;%02d/%02d/%04d", pNode->winegrower.id, pNode->winegrower.document,  
             pNode->winegrower.registrationDate.day, pNode->winegrower.registrationDate.month, pNode->winegrower.registrationDate.year);
@@ -539,15 +1302,22 @@ tApiError api_getWinegrowers(tApiData data, tCSVData *winegrowers) {
 
 // Get registered vineyardplots
 tApiError api_getVineyardplots(tApiData data, tCSVData *vineyards) {
+    return api_getVineyardplots_ptr(&data, vineyards);
+}
+
+// Get registered vineyardplots, without copying the data
+tApiError api_getVineyardplots_ptr(const tApiData* data, tCSVData *vineyards) {
     //////////////////////////////////
     // Ex PR1 3d
     /////////////////////////////////
     char buffer[2048];
     tWinegrowerNode *pNode = NULL;
     
+    assert(data != NULL);
+    
     csv_init(vineyards);
         
-    pNode = data.winegrowers.first;
+    pNode = data->winegrowers.first;
     while(pNode != NULL) {
         
         
@@ -1,11 +1,16 @@
 #ifndef __UOCHEALTHCENTER_API__H
 #define __UOCHEALTHCENTER_API__H
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "error.h"
 #include "csv.h"
 #include "do.h"
 #include "person.h"
 #include "winegrower.h"
+#include "winegrowerindex.h"
+#include "vineyardindex.h"
+#include "arena.h"
 
 
 // Type that stores all the application data
@@ -17,12 +22,32 @@ typedef struct _ApiData {
     tPeople people;	
 	// Winegrowers
     tWinegrowerList winegrowers;
+    // Index of the winegrowers by id
+    tWinegrowerIndex winegrowerIndex;
+    // Index of the vineyardplots of all the winegrowers by code
+    tVineyardIndex vineyardIndex;
     ////////////////////////////////
 	
 	////////////////////////////////
     // PR2 EX3a
     tDOData DOs;
     ////////////////////////////////
+    
+    // Snapshot block the data was restored from, in the arena. Restored strings point into it
+    char* snapshot;
+    size_t snapshotSize;
+    bool snapshotMapped;
+
+    // Checkpoint of the incremental load: bytes of the file already applied and the checksum of
+    // the first and last bytes of them
+    size_t loadOffset;
+    uint64_t loadChecksum;
+
+    // Arena where the api functions allocate the data they store
+    tArena arena;
+
+    // True while the data holds the symbol table, so the codes and ids it interns are released with it
+    bool symbolsHeld;
 } tApiData;
 
 // Get the API version information
@@ -31,15 +56,52 @@ const char* api_version();
 // Load data from a CSV file. If reset is true, remove previous data
 tApiError api_loadData(tApiData* data, const char* filename, bool reset);
 
+// Load the rows appended to a CSV file since the previous call. Only complete lines are applied. Wrong rows
+// are skipped and the checkpoint moves past them, returning the error of the first one. If there
+// is no checkpoint or the part of the file already applied has changed, the data is reloaded from scratch.
+// Changes are detected from a checksum of the first and last 64 KB applied, so the cost of a call depends
+// on the rows appended, not on the size of the file
+tApiError api_loadDataIncremental(tApiData* data, const char* filename);
+
+// Load data from a CSV file using several threads to parse it. Entries are added in the file order
+tApiError api_loadDataParallel(tApiData* data, const char* filename, int threads);
+
 // Add a new entry
 tApiError api_addDataEntry(tApiData* data, tCSVEntry entry);
 
-// Free all used memory
+// Add a batch of entries. Rows are grouped by type and applied in the order PERSON, DO, WINEGROWER,
+// VINEYARD_PLOT and WEIGHING, keeping the input order inside each group. Each group is sorted by key and
+// merged with the current data in a single ordered pass, except the weighings, that are routed to their
+// vineyardplots through the vineyard index. The result of each row is stored in results,
+// that must have room for all the entries. Return the error of the first row that failed
+tApiError api_addDataEntries(tApiData* data, tCSVData* entries, tApiError* results);
+
+// Save all the data to a binary snapshot file. E_FILE_WRITE_ERROR if it could not be written completely
+tApiError api_saveSnapshot(tApiData* data, const char* filename);
+
+// Replace the data with the content of a binary snapshot file. If readOnly is true, restored strings
+// point straight into the mapped file and must not be modified; otherwise the file is read into a
+// single block. The block belongs to the arena of the data, so restored data can be removed as any other
+tApiError api_loadSnapshot(tApiData* data, const char* filename, bool readOnly);
+
+// Free all used memory. The data stored by the api functions is in the arena, so it is released at once.
+// The api copies into the arena the lists it takes that are not in it. Data added to the structures by other
+// means must be released by the caller before. The symbols interned while the data was alive are released
+// when no other data is alive
 tApiError api_freeData(tApiData* data);
 
+// Get the number of bytes used and mapped by the arena of the data
+void api_getArenaUsage(tApiData data, size_t* used, size_t* mapped);
+
+// Get the number of bytes used and mapped by the arena of the data, without copying the data
+void api_getArenaUsage_ptr(const tApiData* data, size_t* used, size_t* mapped);
+
 // Initialize the data structure
 tApiError api_initData(tApiData* data);
 
+// Add a new person
+tApiError api_addPerson(tApiData* data, tCSVEntry entry);
+
 // Add a new winegrower
 tApiError api_addWinegrower(tApiData* data, tCSVEntry entry);
 
@@ -53,31 +115,55 @@ tApiError api_addWeighing(tApiData* data, tCSVEntry entry);
 tApiError api_addDO(tApiData* data, tCSVEntry entry);
 
 // Find a Winegrower in the list of Winegrowers
-tWinegrower* apiWinegrower_find(tApiData* data, const char* id);
+tWinegrower* apiWinegrower_find(const tApiData* data, const char* id);
 
 // Get the number of people registered on the application
 int api_peopleCount(tApiData data);
 
+// Get the number of people registered on the application, without copying the data
+int api_peopleCount_ptr(const tApiData* data);
+
 // Get the number of winegrowersregistered on the application
 int api_winegrowersCount(tApiData data);
 
+// Get the number of winegrowers registered on the application, without copying the data
+int api_winegrowersCount_ptr(const tApiData* data);
+
 // Get the number of vineyardplots in all winegrowers registered on the application
 int api_vineyardplotCount(tApiData data);
 
+// Get the number of vineyardplots in all winegrowers registered on the application, without copying the data
+int api_vineyardplotCount_ptr(const tApiData* data);
+
 // Get the number of DOs redistered on the application
 int api_DOCount(tApiData data);
 
+// Get the number of DOs registered on the application, without copying the data
+int api_DOCount_ptr(const tApiData* data);
+
 // Get winegrower data
 tApiError api_getWinegrower(tApiData data, const char *id, tCSVEntry *entry);
 
+// Get winegrower data, without copying the data
+tApiError api_getWinegrower_ptr(const tApiData* data, const char *id, tCSVEntry *entry);
+
 // Get registered winegrowers
 tApiError api_getWinegrowers(tApiData data, tCSVData *winegrowers);
 
+// Get registered winegrowers, without copying the data
+tApiError api_getWinegrowers_ptr(const tApiData* data, tCSVData *winegrowers);
+
 // Get vineyardplot
 tApiError api_getVineyardplot(tApiData data, const char* vineyardCode, tCSVEntry *entry);
 
+// Get vineyardplot, without copying the data
+tApiError api_getVineyardplot_ptr(const tApiData* data, const char* vineyardCode, tCSVEntry *entry);
+
 // Get registered vineyardsplots
 tApiError api_getVineyardplots(tApiData data, tCSVData *vineyards);
 
+// Get registered vineyardsplots, without copying the data
+tApiError api_getVineyardplots_ptr(const tApiData* data, tCSVData *vineyards);
+
 
 #endif // __UOCHEALTHCENTER_API__H
\ No newline at end of file
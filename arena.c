@@ -0,0 +1,390 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "arena.h"
+
+// Space taken by the header at the start of each chunk
+#define ARENA_HEADER_SIZE ((sizeof(tArenaChunk) + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1))
+
+// The map from granules to chunks has three levels. The two lower ones take ARENA_MAP_BITS bits of the
+// granule number each, and the top one the rest of the 48 bits of a user space address
+#define ARENA_MAP_BITS 10
+#define ARENA_MAP_SIZE (1 << ARENA_MAP_BITS)
+#define ARENA_MAP_TOP_SIZE ((size_t) 1 << (48 - ARENA_GRANULE_BITS - 2 * ARENA_MAP_BITS))
+
+// Lowest level of the map: the chunk of each granule, NULL for granules of no chunk
+typedef struct _tArenaMapLeaf {
+    tArenaChunk* chunks[ARENA_MAP_SIZE];
+} tArenaMapLeaf;
+
+// Middle level of the map
+typedef struct _tArenaMapNode {
+    tArenaMapLeaf* leaves[ARENA_MAP_SIZE];
+} tArenaMapNode;
+
+// Chunk of each granule of the chunks of all the arenas. Levels are allocated when a chunk needs them and
+// are never released, so the map is read without the lock
+static tArenaMapNode* arena_map[ARENA_MAP_TOP_SIZE];
+static pthread_mutex_t arena_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Active arena of each thread
+static __thread tArena* arena_active = NULL;
+
+// Round a size up to the alignment of the blocks
+static size_t arena_align(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+}
+
+// Find the chunk that contains a block, without the lock. NULL if no arena gave it
+static tArenaChunk* arena_findChunk(const void* ptr) {
+    tArenaMapNode* node;
+    tArenaMapLeaf* leaf;
+    uintptr_t granule;
+
+    granule = (uintptr_t) ptr >> ARENA_GRANULE_BITS;
+    if ((granule >> (2 * ARENA_MAP_BITS)) >= ARENA_MAP_TOP_SIZE) {
+        return NULL;
+    }
+
+    node = __atomic_load_n(&(arena_map[granule >> (2 * ARENA_MAP_BITS)]), __ATOMIC_ACQUIRE);
+    if (node == NULL) {
+        return NULL;
+    }
+    leaf = __atomic_load_n(&(node->leaves[(granule >> ARENA_MAP_BITS) & (ARENA_MAP_SIZE - 1)]), __ATOMIC_ACQUIRE);
+    if (leaf == NULL) {
+        return NULL;
+    }
+
+    return __atomic_load_n(&(leaf->chunks[granule & (ARENA_MAP_SIZE - 1)]), __ATOMIC_ACQUIRE);
+}
+
+// Set the chunk of all the granules of a chunk. NULL removes them. Called with the lock held
+static void arena_setGranules(tArenaChunk* chunk, tArenaChunk* value) {
+    tArenaMapNode* node;
+    tArenaMapLeaf* leaf;
+    uintptr_t granule, last;
+    size_t top, middle;
+
+    granule = (uintptr_t) chunk >> ARENA_GRANULE_BITS;
+    last = granule + (chunk->size >> ARENA_GRANULE_BITS);
+    assert(((last - 1) >> (2 * ARENA_MAP_BITS)) < ARENA_MAP_TOP_SIZE);
+
+    for (; granule < last; granule++) {
+        top = granule >> (2 * ARENA_MAP_BITS);
+        middle = (granule >> ARENA_MAP_BITS) & (ARENA_MAP_SIZE - 1);
+
+        // Levels are complete before they are published, so a reader without the lock never sees them half filled
+        node = arena_map[top];
+        if (node == NULL) {
+            node = (tArenaMapNode*) calloc(1, sizeof(tArenaMapNode));
+            assert(node != NULL);
+            __atomic_store_n(&(arena_map[top]), node, __ATOMIC_RELEASE);
+        }
+        leaf = node->leaves[middle];
+        if (leaf == NULL) {
+            leaf = (tArenaMapLeaf*) calloc(1, sizeof(tArenaMapLeaf));
+            assert(leaf != NULL);
+            __atomic_store_n(&(node->leaves[middle]), leaf, __ATOMIC_RELEASE);
+        }
+        __atomic_store_n(&(leaf->chunks[granule & (ARENA_MAP_SIZE - 1)]), value, __ATOMIC_RELEASE);
+    }
+}
+
+// Add the granules of a new chunk to the map
+static void arena_addChunk(tArenaChunk* chunk) {
+    pthread_mutex_lock(&arena_lock);
+    arena_setGranules(chunk, chunk);
+    pthread_mutex_unlock(&arena_lock);
+}
+
+// Remove the granules of a chunk from the map
+static void arena_removeChunk(tArenaChunk* chunk) {
+    pthread_mutex_lock(&arena_lock);
+    arena_setGranules(chunk, NULL);
+    pthread_mutex_unlock(&arena_lock);
+}
+
+// Map memory of the given size, a multiple of the granule, starting at a multiple of the granule. NULL if it fails
+static char* arena_mapAligned(size_t size) {
+    char *memory, *start;
+    size_t extra;
+
+    // Map a granule more than needed and unmap the parts before and after the aligned range
+    memory = (char*) mmap(NULL, size + ARENA_GRANULE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return NULL;
+    }
+    start = (char*) (((uintptr_t) memory + ARENA_GRANULE_SIZE - 1) & ~((uintptr_t) ARENA_GRANULE_SIZE - 1));
+    extra = start - memory;
+    if (extra > 0) {
+        munmap(memory, extra);
+    }
+    if (ARENA_GRANULE_SIZE - extra > 0) {
+        munmap(start + size, ARENA_GRANULE_SIZE - extra);
+    }
+
+    return start;
+}
+
+// Round a size up to a whole number of granules
+static size_t arena_granules(size_t size) {
+    return (size + ARENA_GRANULE_SIZE - 1) & ~(ARENA_GRANULE_SIZE - 1);
+}
+
+// Map a new chunk with room for a block of the given size
+static void arena_grow(tArena* arena, size_t size) {
+    tArenaChunk* chunk;
+    size_t chunkSize;
+
+    // Each chunk doubles the previous one, so a large dataset needs few of them
+    chunkSize = (arena->chunks == NULL) ? ARENA_INITIAL_CHUNK_SIZE : arena->chunks->size * 2;
+    if (chunkSize > ARENA_MAX_CHUNK_SIZE) {
+        chunkSize = ARENA_MAX_CHUNK_SIZE;
+    }
+    if (chunkSize < size + ARENA_HEADER_SIZE) {
+        chunkSize = arena_granules(size + ARENA_HEADER_SIZE);
+    }
+
+    chunk = (tArenaChunk*) arena_mapAligned(chunkSize);
+    assert(chunk != NULL);
+
+    chunk->arena = arena;
+    chunk->size = chunkSize;
+    chunk->used = ARENA_HEADER_SIZE;
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    arena->mapped += chunkSize;
+
+    arena_addChunk(chunk);
+}
+
+// Get a block of memory from an arena
+static void* arena_allocate(tArena* arena, size_t size) {
+    void* ptr;
+
+    size = arena_align(size);
+    if (arena->chunks == NULL || arena->chunks->size - arena->chunks->used < size) {
+        arena_grow(arena, size);
+    }
+
+    ptr = (char*) arena->chunks + arena->chunks->used;
+    arena->chunks->used += size;
+    arena->used += size;
+
+    return ptr;
+}
+
+// Initialize an empty arena
+void arena_init(tArena* arena) {
+    assert(arena != NULL);
+
+    arena->chunks = NULL;
+    arena->used = 0;
+    arena->mapped = 0;
+}
+
+// Release all the chunks of the arena, and all the blocks given by it
+void arena_release(tArena* arena) {
+    tArenaChunk* chunk;
+
+    assert(arena != NULL);
+
+    while (arena->chunks != NULL) {
+        chunk = arena->chunks;
+        arena->chunks = chunk->next;
+        arena_removeChunk(chunk);
+        munmap(chunk, chunk->size);
+    }
+    arena_init(arena);
+}
+
+// Make an arena the active one of the calling thread
+tArena* arena_enter(tArena* arena) {
+    tArena* previous;
+
+    previous = arena_active;
+    arena_active = arena;
+
+    return previous;
+}
+
+// Restore the active arena of the calling thread
+void arena_leave(tArena* previous) {
+    arena_active = previous;
+}
+
+// Get the active arena of the calling thread
+tArena* arena_current() {
+    return arena_active;
+}
+
+// Get a block of memory from the active arena, or from the heap if there is no active arena
+void* arena_malloc(size_t size) {
+    if (arena_active == NULL) {
+        return malloc(size);
+    }
+
+    return arena_allocate(arena_active, size);
+}
+
+// Get a block of memory starting at a multiple of alignment from the active arena or from the heap
+void* arena_mallocAligned(size_t alignment, size_t size) {
+    uintptr_t ptr;
+
+    assert(alignment >= ARENA_ALIGNMENT && (alignment & (alignment - 1)) == 0);
+
+    if (arena_active == NULL) {
+        // The size of an aligned heap block must be a multiple of the alignment
+        return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+    }
+
+    // Blocks of an arena are never released one by one, so the space skipped before the block is not kept
+    ptr = (uintptr_t) arena_allocate(arena_active, size + alignment - ARENA_ALIGNMENT);
+    return (void*) ((ptr + alignment - 1) & ~((uintptr_t) alignment - 1));
+}
+
+// Get a block of memory set to zero from the active arena, or from the heap if there is no active arena
+void* arena_calloc(size_t count, size_t size) {
+    void* ptr;
+
+    if (arena_active == NULL) {
+        return calloc(count, size);
+    }
+
+    ptr = arena_allocate(arena_active, count * size);
+    memset(ptr, 0, count * size);
+
+    return ptr;
+}
+
+// Resize a block of oldSize bytes. Blocks of an arena stay in the same arena, heap blocks stay in the heap
+void* arena_realloc(void* ptr, size_t oldSize, size_t size) {
+    tArenaChunk* chunk;
+    char* end;
+    void* block;
+
+    if (ptr == NULL) {
+        return arena_malloc(size);
+    }
+    chunk = arena_findChunk(ptr);
+    if (chunk == NULL) {
+        return realloc(ptr, size);
+    }
+
+    // The last block of the chunk takes or gives back the free space that follows it
+    oldSize = arena_align(oldSize);
+    size = arena_align(size);
+    end = (char*) chunk + chunk->used;
+    if ((char*) ptr + oldSize == end && (size_t) ((char*) chunk + chunk->size - (char*) ptr) >= size) {
+        chunk->used = (char*) ptr + size - (char*) chunk;
+        chunk->arena->used = chunk->arena->used - oldSize + size;
+        return ptr;
+    }
+
+    block = arena_allocate(chunk->arena, size);
+    memcpy(block, ptr, (oldSize < size) ? oldSize : size);
+
+    return block;
+}
+
+// Number of elements allocated for a vector of count elements that grows with arena_reserve
+size_t arena_vectorCapacity(size_t count) {
+    size_t capacity;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    capacity = ARENA_VECTOR_MIN_CAPACITY;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+
+    return capacity;
+}
+
+// Make room for one more element in a vector of count elements of the given size, that only keeps its count
+void* arena_reserve(void* ptr, size_t count, size_t size) {
+    size_t capacity;
+
+    capacity = arena_vectorCapacity(count);
+    if (count < capacity) {
+        return ptr;
+    }
+
+    return arena_realloc(ptr, capacity * size, arena_vectorCapacity(count + 1) * size);
+}
+
+// Map the first size bytes of a file read-only as a block of an arena
+void* arena_mapFile(tArena* arena, int fd, size_t size) {
+    tArenaChunk* chunk;
+    size_t page, headerSize, chunkSize;
+    char* memory;
+
+    assert(arena != NULL);
+    assert(size > 0);
+
+    // The header of the chunk takes its own pages, as the pages of the file can not be written. As any
+    // other chunk, it takes a whole number of granules
+    page = (size_t) sysconf(_SC_PAGESIZE);
+    headerSize = (ARENA_HEADER_SIZE + page - 1) & ~(page - 1);
+    chunkSize = arena_granules(headerSize + size);
+
+    memory = arena_mapAligned(chunkSize);
+    if (memory == NULL) {
+        return NULL;
+    }
+    if (mmap(memory + headerSize, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(memory, chunkSize);
+        return NULL;
+    }
+
+    // The chunk is full. Link it after the first one, that keeps giving the new blocks
+    chunk = (tArenaChunk*) memory;
+    chunk->arena = arena;
+    chunk->size = chunkSize;
+    chunk->used = chunkSize;
+    if (arena->chunks == NULL) {
+        chunk->next = NULL;
+        arena->chunks = chunk;
+    } else {
+        chunk->next = arena->chunks->next;
+        arena->chunks->next = chunk;
+    }
+    arena->used += size;
+    arena->mapped += chunkSize;
+
+    arena_addChunk(chunk);
+
+    return memory + headerSize;
+}
+
+// Release a block. Heap blocks are released now, blocks of an arena when the arena is released
+void arena_free(void* ptr) {
+    if (ptr != NULL && arena_findChunk(ptr) == NULL) {
+        free(ptr);
+    }
+}
+
+// Check if a block was given by an arena
+bool arena_contains(const void* ptr) {
+    return ptr != NULL && arena_findChunk(ptr) != NULL;
+}
+
+// Number of bytes given by the arena
+size_t arena_used(const tArena* arena) {
+    assert(arena != NULL);
+
+    return arena->used;
+}
+
+// Number of bytes mapped by the arena
+size_t arena_mapped(const tArena* arena) {
+    assert(arena != NULL);
+
+    return arena->mapped;
+}
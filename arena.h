@@ -0,0 +1,94 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Size of the first chunk mapped by an arena. Each new chunk doubles the previous one up to the maximum
+#define ARENA_INITIAL_CHUNK_SIZE (64 * 1024)
+#define ARENA_MAX_CHUNK_SIZE (16 * 1024 * 1024)
+
+// Chunks start at a multiple of the granule and take a whole number of granules, so each granule of
+// memory belongs to one chunk at most. It is the size of the first chunk
+#define ARENA_GRANULE_BITS 16
+#define ARENA_GRANULE_SIZE ((size_t) 1 << ARENA_GRANULE_BITS)
+
+// Alignment of all the blocks given by an arena
+#define ARENA_ALIGNMENT 8
+
+// Minimum number of elements allocated for a vector that grows with arena_reserve
+#define ARENA_VECTOR_MIN_CAPACITY 4
+
+struct _tArena;
+
+// Chunk of memory mapped by an arena. Blocks are given from the start of the free space
+typedef struct _tArenaChunk {
+    struct _tArenaChunk* next;
+    struct _tArena* arena;
+    size_t size;
+    size_t used;
+} tArenaChunk;
+
+// Region of memory where all the blocks are released at once. Chunks are kept from the newest to the oldest
+typedef struct _tArena {
+    tArenaChunk* chunks;
+    size_t used;
+    size_t mapped;
+} tArena;
+
+// Initialize an empty arena
+void arena_init(tArena* arena);
+
+// Release all the chunks of the arena, and all the blocks given by it
+void arena_release(tArena* arena);
+
+// Make an arena the active one of the calling thread. Return the previous active arena, to restore it with arena_leave
+tArena* arena_enter(tArena* arena);
+
+// Restore the active arena of the calling thread
+void arena_leave(tArena* previous);
+
+// Get the active arena of the calling thread. NULL if there is none
+tArena* arena_current();
+
+// Get a block of memory from the active arena, or from the heap if there is no active arena
+void* arena_malloc(size_t size);
+
+// Get a block of memory set to zero from the active arena, or from the heap if there is no active arena
+void* arena_calloc(size_t count, size_t size);
+
+// Get a block of memory starting at a multiple of alignment, a power of two, from the active arena or from
+// the heap. It is released with arena_free as any other block
+void* arena_mallocAligned(size_t alignment, size_t size);
+
+// Resize a block of oldSize bytes. Blocks of an arena stay in the same arena, heap blocks stay in the heap.
+// The last block of a chunk grows in place while the chunk has room
+void* arena_realloc(void* ptr, size_t oldSize, size_t size);
+
+// Number of elements allocated for a vector of count elements that grows with arena_reserve: the next
+// power of two, and at least ARENA_VECTOR_MIN_CAPACITY. 0 for an empty vector
+size_t arena_vectorCapacity(size_t count);
+
+// Make room for one more element in a vector of count elements of the given size, that only keeps its count.
+// The capacity is doubled when the vector is full, so it is always arena_vectorCapacity(count). Vectors
+// filled by other means must be allocated with that capacity too
+void* arena_reserve(void* ptr, size_t count, size_t size);
+
+// Map the first size bytes of a file read-only as a block of an arena. The mapping is released with the
+// arena, and arena_free and arena_contains treat pointers into it as arena blocks. NULL if it can not be mapped
+void* arena_mapFile(tArena* arena, int fd, size_t size);
+
+// Release a block. Heap blocks are released now, blocks of an arena when the arena is released.
+// It does not take any lock
+void arena_free(void* ptr);
+
+// Check if a block was given by an arena. It does not take any lock
+bool arena_contains(const void* ptr);
+
+// Number of bytes given by the arena
+size_t arena_used(const tArena* arena);
+
+// Number of bytes mapped by the arena
+size_t arena_mapped(const tArena* arena);
+
+#endif
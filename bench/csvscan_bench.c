@@ -0,0 +1,126 @@
+// Throughput of the CSV delimiter scan, in GB/s, against the strchr loops it replaced.
+// Build from the root of the repository:
+//   gcc -O2 -I. bench/csvscan_bench.c csvscan.c -o csvscan_bench -lpthread
+// Usage: csvscan_bench [megabytes] [rounds]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "csvscan.h"
+
+// Default size of the generated buffer and number of times it is scanned
+#define BENCH_DEFAULT_MB 64
+#define BENCH_DEFAULT_ROUNDS 10
+
+typedef void (*tBenchFunc)(tCSVScan* scan, const char* buffer, int len);
+
+// Current time in seconds
+static double bench_now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Fill a buffer with WEIGHING lines like the ones of the input files
+static char* bench_makeBuffer(int size) {
+    char line[128];
+    char* buffer;
+    int used, len, i;
+
+    buffer = (char*) malloc(size + 1);
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    used = 0;
+    for (i = 0; used < size; i++) {
+        len = snprintf(line, sizeof(line), "WEIGHING;PE-2024-%05d;W%06d;%02d/%02d/2024;%d.%02d;2\n",
+                i % 100000, i % 1000, 1 + i % 28, 1 + i % 12, 100 + i % 900, i % 100);
+        if (len > size - used) {
+            len = size - used;
+        }
+        memcpy(buffer + used, line, len);
+        used += len;
+    }
+    // End with a complete line, so all the versions count the same delimiters
+    buffer[size - 1] = '\n';
+    buffer[size] = '\0';
+
+    return buffer;
+}
+
+// Previous approach: one strchr for the end of each line and another one for each separator in the line
+static void bench_runStrchr(tCSVScan* scan, const char* buffer, int len) {
+    const char *line, *end, *field;
+
+    scan->count = 0;
+    line = buffer;
+    while (line < buffer + len) {
+        end = strchr(line, '\n');
+        if (end == NULL) {
+            end = buffer + len;
+        }
+        field = line;
+        while ((field = strchr(field, ';')) != NULL && field < end) {
+            scan->count++;
+            field++;
+        }
+        scan->count++;
+        line = end + 1;
+    }
+}
+
+// Scan the buffer several times and print the throughput. Return the number of delimiters found
+static int bench_run(const char* name, tBenchFunc func, const char* buffer, int len, int rounds) {
+    tCSVScan scan;
+    double start, elapsed;
+    int i, count;
+
+    csvScan_init(&scan);
+    func(&scan, buffer, len);
+
+    start = bench_now();
+    for (i = 0; i < rounds; i++) {
+        func(&scan, buffer, len);
+    }
+    elapsed = bench_now() - start;
+    count = scan.count;
+    csvScan_free(&scan);
+
+    printf("%-8s %8.3f GB/s  %d delimiters\n", name, (double) len * rounds / elapsed / 1e9, count);
+
+    return count;
+}
+
+int main(int argc, char** argv) {
+    char* buffer;
+    int megabytes, rounds, len;
+    int expected;
+
+    megabytes = (argc > 1) ? atoi(argv[1]) : BENCH_DEFAULT_MB;
+    rounds = (argc > 2) ? atoi(argv[2]) : BENCH_DEFAULT_ROUNDS;
+    if (megabytes <= 0 || megabytes > 1024 || rounds <= 0) {
+        fprintf(stderr, "usage: %s [megabytes (1-1024)] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    len = megabytes * 1024 * 1024;
+    buffer = bench_makeBuffer(len);
+    if (buffer == NULL) {
+        fprintf(stderr, "not enough memory\n");
+        return 1;
+    }
+
+    printf("%d MB, %d rounds, csvScan_run uses %s\n", megabytes, rounds, csvScan_implementation());
+    expected = bench_run("strchr", bench_runStrchr, buffer, len, rounds);
+    if (bench_run("scalar", csvScan_runScalar, buffer, len, rounds) != expected
+            || bench_run(csvScan_implementation(), csvScan_run, buffer, len, rounds) != expected) {
+        fprintf(stderr, "the scans found a different number of delimiters\n");
+        free(buffer);
+        return 1;
+    }
+
+    free(buffer);
+    return 0;
+}
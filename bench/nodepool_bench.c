@@ -0,0 +1,162 @@
+// Time of do_getTotalWeighing_ptr walking the lists of a DO with no totals or weighing store, over nodes taken
+// from malloc, as before the pools, and from the node pools. Both variants build the same data, the code of each
+// weighing taken from malloc, and only differ in where the nodes come from. The weighings are added to the plots
+// in turns, as they come in the input files.
+// Build from the root of the repository of the full project (it needs winegrower.h, vineyardplot.h and weighing.h):
+//   gcc -O2 -I. bench/nodepool_bench.c *.c -o nodepool_bench -lpthread
+// Usage: nodepool_bench [winegrowers] [weighings per plot] [rounds]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "do.h"
+#include "nodepool.h"
+
+// Default size of the data: winegrowers, plots of each winegrower and weighings of each plot
+#define BENCH_DEFAULT_WINEGROWERS 20000
+#define BENCH_PLOTS 4
+#define BENCH_DEFAULT_WEIGHINGS 25
+
+// Default number of times the lists are walked
+#define BENCH_DEFAULT_ROUNDS 20
+
+// Length of the weighing codes, including the '\0'
+#define BENCH_CODE_SIZE 8
+
+// Current time in seconds
+static double bench_now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Get a weighing node, from the pool or from malloc as before the pools
+static tWeighingNode* bench_newWeighingNode(bool pooled, int number) {
+    tWeighingNode* node;
+
+    node = pooled ? nodePool_newWeighingNode() : (tWeighingNode*) malloc(sizeof(tWeighingNode));
+    node->elem.code = (char*) malloc(BENCH_CODE_SIZE);
+    snprintf(node->elem.code, BENCH_CODE_SIZE, "C%06d", number % 1000000);
+    node->elem.weight = (float) (1 + number % 50);
+    node->elem.harvestDay.day = 1 + number % 28;
+    node->elem.harvestDay.month = 9;
+    node->elem.harvestDay.year = 2020 + number % 4;
+    node->next = NULL;
+
+    return node;
+}
+
+// Build the winegrower list. The weighings are added to all the plots in turns
+static void bench_build(tWinegrowerList* list, int winegrowers, int weighings, bool pooled) {
+    tWinegrowerNode** nodes;
+    tVineyardplot* plot;
+    tWeighingNode* node;
+    int i, j, k, number;
+
+    nodes = (tWinegrowerNode**) malloc(winegrowers * sizeof(tWinegrowerNode*));
+    list->first = NULL;
+    list->count = winegrowers;
+    for (i = winegrowers - 1; i >= 0; i--) {
+        nodes[i] = pooled ? nodePool_newWinegrowerNode() : (tWinegrowerNode*) malloc(sizeof(tWinegrowerNode));
+        memset(&(nodes[i]->winegrower), 0, sizeof(tWinegrower));
+        nodes[i]->winegrower.vineyardplots.elems = (tVineyardplot*) calloc(BENCH_PLOTS, sizeof(tVineyardplot));
+        nodes[i]->winegrower.vineyardplots.count = BENCH_PLOTS;
+        nodes[i]->next = list->first;
+        list->first = nodes[i];
+    }
+
+    number = 0;
+    for (k = 0; k < weighings; k++) {
+        for (i = 0; i < winegrowers; i++) {
+            for (j = 0; j < BENCH_PLOTS; j++) {
+                plot = &(nodes[i]->winegrower.vineyardplots.elems[j]);
+                node = bench_newWeighingNode(pooled, number++);
+                node->prev = plot->weights.last;
+                if (plot->weights.last == NULL) {
+                    plot->weights.first = node;
+                } else {
+                    plot->weights.last->next = node;
+                }
+                plot->weights.last = node;
+            }
+        }
+    }
+    free(nodes);
+}
+
+// Release the winegrower list built by bench_build
+static void bench_free(tWinegrowerList* list, bool pooled) {
+    tWinegrowerNode *pNode, *pNext;
+    tWeighingNode *node, *next;
+    int j;
+
+    for (pNode = list->first; pNode != NULL; pNode = pNext) {
+        pNext = pNode->next;
+        for (j = 0; j < pNode->winegrower.vineyardplots.count; j++) {
+            for (node = pNode->winegrower.vineyardplots.elems[j].weights.first; node != NULL; node = next) {
+                next = node->next;
+                free(node->elem.code);
+                if (pooled) {
+                    nodePool_freeWeighingNode(node);
+                } else {
+                    free(node);
+                }
+            }
+        }
+        free(pNode->winegrower.vineyardplots.elems);
+        if (pooled) {
+            nodePool_freeWinegrowerNode(pNode);
+        } else {
+            free(pNode);
+        }
+    }
+    list->first = NULL;
+    list->count = 0;
+}
+
+// Build the lists of a DO, get its totals and print the time per node. Return the total weight of the walks
+static double bench_run(const char* name, int winegrowers, int weighings, int rounds, bool pooled) {
+    tDO DO;
+    double start, elapsed, total;
+    long nodes;
+    int i;
+
+    // The lists are linked to the DO by hand, so it has no totals or weighing store and the lists are walked
+    do_initEmpty(&DO);
+    bench_build(&(DO.winegrowers), winegrowers, weighings, pooled);
+    total = do_getTotalWeighing_ptr(&DO, 2021);
+
+    start = bench_now();
+    for (i = 0; i < rounds; i++) {
+        total += do_getTotalWeighing_ptr(&DO, 2020 + i % 4);
+    }
+    elapsed = bench_now() - start;
+    bench_free(&(DO.winegrowers), pooled);
+
+    nodes = (long) winegrowers * BENCH_PLOTS * weighings;
+    printf("%-8s %9ld weighings %8.3f ms/walk  %6.2f ns/node\n", name, nodes, elapsed * 1e3 / rounds,
+            elapsed * 1e9 / rounds / nodes);
+
+    return total;
+}
+
+int main(int argc, char** argv) {
+    int winegrowers, weighings, rounds;
+
+    winegrowers = (argc > 1) ? atoi(argv[1]) : BENCH_DEFAULT_WINEGROWERS;
+    weighings = (argc > 2) ? atoi(argv[2]) : BENCH_DEFAULT_WEIGHINGS;
+    rounds = (argc > 3) ? atoi(argv[3]) : BENCH_DEFAULT_ROUNDS;
+    if (winegrowers <= 0 || weighings <= 0 || rounds <= 0) {
+        fprintf(stderr, "usage: %s [winegrowers] [weighings per plot] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    if (bench_run("malloc", winegrowers, weighings, rounds, false)
+            != bench_run("pools", winegrowers, weighings, rounds, true)) {
+        fprintf(stderr, "the walks gave different totals\n");
+        return 1;
+    }
+
+    return 0;
+}
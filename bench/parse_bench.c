@@ -0,0 +1,144 @@
+// Speed of the field parsers against the libc functions used before them (atof, atoi and sscanf).
+// Build from the root of the repository:
+//   gcc -O2 -I. bench/parse_bench.c parse.c -o parse_bench
+// Usage: parse_bench [millions of fields]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "parse.h"
+
+// Default number of fields parsed by each version, in millions
+#define BENCH_DEFAULT_MILLIONS 5
+
+// Number of distinct fields generated. Each version parses them in a loop
+#define BENCH_NUM_FIELDS 4096
+
+// Maximum length of a generated field, including the '\0'
+#define BENCH_FIELD_SIZE 16
+
+// Fields of each kind, null terminated as the fields of a parsed entry
+static char bench_reals[BENCH_NUM_FIELDS][BENCH_FIELD_SIZE];
+static char bench_integers[BENCH_NUM_FIELDS][BENCH_FIELD_SIZE];
+static char bench_dates[BENCH_NUM_FIELDS][BENCH_FIELD_SIZE];
+static char bench_times[BENCH_NUM_FIELDS][BENCH_FIELD_SIZE];
+static int bench_lengths[4][BENCH_NUM_FIELDS];
+
+// Current time in seconds
+static double bench_now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Generate fields like the ones of the input files: weights as "20.00", counters, dates and times
+static void bench_makeFields() {
+    int i;
+
+    srand(1);
+    for (i = 0; i < BENCH_NUM_FIELDS; i++) {
+        bench_lengths[0][i] = sprintf(bench_reals[i], "%d.%02d", rand() % 5000, rand() % 100);
+        bench_lengths[1][i] = sprintf(bench_integers[i], "%d", rand() % 100000);
+        bench_lengths[2][i] = sprintf(bench_dates[i], "%02d/%02d/%04d", 1 + rand() % 28, 1 + rand() % 12, 2000 + rand() % 30);
+        bench_lengths[3][i] = sprintf(bench_times[i], "%02d:%02d", rand() % 24, rand() % 60);
+    }
+}
+
+// Print the time per field of a version
+static void bench_report(const char* name, double elapsed, long count, double check) {
+    printf("%-16s %8.2f ns/field  (check %.2f)\n", name, elapsed * 1e9 / count, check);
+}
+
+int main(int argc, char** argv) {
+    double start, check, real;
+    long count, n;
+    int i, value, day, month, year, hour, minutes;
+
+    count = ((argc > 1) ? atol(argv[1]) : BENCH_DEFAULT_MILLIONS) * 1000000L;
+    if (count <= 0) {
+        fprintf(stderr, "usage: %s [millions of fields]\n", argv[0]);
+        return 1;
+    }
+    bench_makeFields();
+
+    // Both versions have to give the same values before comparing their speed
+    for (i = 0; i < BENCH_NUM_FIELDS; i++) {
+        parse_double(bench_reals[i], bench_lengths[0][i], &real);
+        parse_integer(bench_integers[i], bench_lengths[1][i], &value);
+        parse_date(bench_dates[i], bench_lengths[2][i], &day, &month, &year);
+        if (real != atof(bench_reals[i]) || value != atoi(bench_integers[i])
+                || day != atoi(bench_dates[i]) || year != atoi(bench_dates[i] + 6)) {
+            fprintf(stderr, "different values for field %d\n", i);
+            return 1;
+        }
+    }
+
+    check = 0.0;
+    start = bench_now();
+    for (n = 0; n < count; n++) {
+        check += atof(bench_reals[n % BENCH_NUM_FIELDS]);
+    }
+    bench_report("atof", bench_now() - start, count, check);
+
+    check = 0.0;
+    start = bench_now();
+    for (n = 0; n < count; n++) {
+        i = n % BENCH_NUM_FIELDS;
+        parse_double(bench_reals[i], bench_lengths[0][i], &real);
+        check += real;
+    }
+    bench_report("parse_double", bench_now() - start, count, check);
+
+    check = 0.0;
+    start = bench_now();
+    for (n = 0; n < count; n++) {
+        check += atoi(bench_integers[n % BENCH_NUM_FIELDS]);
+    }
+    bench_report("atoi", bench_now() - start, count, check);
+
+    check = 0.0;
+    start = bench_now();
+    for (n = 0; n < count; n++) {
+        i = n % BENCH_NUM_FIELDS;
+        parse_integer(bench_integers[i], bench_lengths[1][i], &value);
+        check += value;
+    }
+    bench_report("parse_integer", bench_now() - start, count, check);
+
+    check = 0.0;
+    start = bench_now();
+    for (n = 0; n < count; n++) {
+        sscanf(bench_dates[n % BENCH_NUM_FIELDS], "%d/%d/%d", &day, &month, &year);
+        check += day + month + year;
+    }
+    bench_report("sscanf date", bench_now() - start, count, check);
+
+    check = 0.0;
+    start = bench_now();
+    for (n = 0; n < count; n++) {
+        i = n % BENCH_NUM_FIELDS;
+        parse_date(bench_dates[i], bench_lengths[2][i], &day, &month, &year);
+        check += day + month + year;
+    }
+    bench_report("parse_date", bench_now() - start, count, check);
+
+    check = 0.0;
+    start = bench_now();
+    for (n = 0; n < count; n++) {
+        sscanf(bench_times[n % BENCH_NUM_FIELDS], "%d:%d", &hour, &minutes);
+        check += hour + minutes;
+    }
+    bench_report("sscanf time", bench_now() - start, count, check);
+
+    check = 0.0;
+    start = bench_now();
+    for (n = 0; n < count; n++) {
+        i = n % BENCH_NUM_FIELDS;
+        parse_time(bench_times[i], bench_lengths[3][i], &hour, &minutes);
+        check += hour + minutes;
+    }
+    bench_report("parse_time", bench_now() - start, count, check);
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+// Time to load winegrowers in id order with the B+tree of the index against the walk of winegrowerList_insert.
+// Build from the root of the repository of the full project (it needs winegrower.h, vineyardplot.h and weighing.h):
+//   gcc -O2 -I. bench/winegrower_bench.c *.c -o winegrower_bench -lpthread
+// Usage: winegrower_bench [winegrowers] [winegrowers for the list walk]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "winegrower.h"
+#include "winegrowerindex.h"
+
+// Default number of winegrowers loaded with the index
+#define BENCH_DEFAULT_WINEGROWERS 1000000
+
+// Default number of winegrowers loaded with the list walk. Each insert walks the list, so it is O(N^2)
+#define BENCH_DEFAULT_WALK 20000
+
+// Maximum length of a generated id or document, including the '\0'
+#define BENCH_TEXT_SIZE 16
+
+// Current time in seconds
+static double bench_now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Return the numbers from 0 to count - 1 in random order, so the ids do not arrive sorted
+static int* bench_makeOrder(int count) {
+    int* order;
+    int i, j, tmp;
+
+    order = (int*) malloc(count * sizeof(int));
+    if (order == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    srand(1);
+    for (i = count - 1; i > 0; i--) {
+        j = (int) (((long) rand() * RAND_MAX + rand()) % (i + 1));
+        tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    return order;
+}
+
+// Initialize the winegrower with the given number
+static void bench_makeWinegrower(tWinegrower* winegrower, int number) {
+    char id[BENCH_TEXT_SIZE], document[BENCH_TEXT_SIZE];
+    tDate date;
+
+    snprintf(id, sizeof(id), "W%07d", number);
+    snprintf(document, sizeof(document), "%08dX", number);
+    date.day = 1 + number % 28;
+    date.month = 1 + number % 12;
+    date.year = 2000 + number % 25;
+    winegrower_init(winegrower, id, document, date);
+}
+
+// Check that the list has count winegrowers sorted by id
+static bool bench_checkOrder(tWinegrowerList list, int count) {
+    tWinegrowerNode* pNode;
+    int n;
+
+    n = 0;
+    for (pNode = list.first; pNode != NULL; pNode = pNode->next) {
+        if (pNode->next != NULL && strcmp(pNode->winegrower.id, pNode->next->winegrower.id) >= 0) {
+            return false;
+        }
+        n++;
+    }
+
+    return n == count && list.count == count;
+}
+
+// Load the winegrowers walking the list on each insert. Return the elapsed time, or -1 if the list is wrong
+static double bench_loadWalk(const int* order, int count) {
+    tWinegrowerList list;
+    tWinegrower winegrower;
+    double start, elapsed;
+    int i;
+
+    winegrowerList_init(&list);
+    start = bench_now();
+    for (i = 0; i < count; i++) {
+        bench_makeWinegrower(&winegrower, order[i]);
+        winegrowerList_insert(&list, winegrower);
+        winegrower_free(&winegrower);
+    }
+    elapsed = bench_now() - start;
+
+    if (!bench_checkOrder(list, count)) {
+        elapsed = -1;
+    }
+    winegrowerList_free(&list);
+
+    return elapsed;
+}
+
+// Load the winegrowers with the index and find each of them. Return the elapsed time of the load, or -1 if
+// the list is wrong
+static double bench_loadIndex(const int* order, int count, double* findTime) {
+    tWinegrowerIndex index;
+    tWinegrowerList list;
+    tWinegrower winegrower;
+    char id[BENCH_TEXT_SIZE];
+    double start, elapsed;
+    int i, found;
+
+    winegrowerList_init(&list);
+    winegrowerIndex_init(&index);
+    start = bench_now();
+    for (i = 0; i < count; i++) {
+        bench_makeWinegrower(&winegrower, order[i]);
+        winegrowerIndex_insertMove(&index, &list, &winegrower);
+    }
+    elapsed = bench_now() - start;
+
+    found = 0;
+    start = bench_now();
+    for (i = 0; i < count; i++) {
+        snprintf(id, sizeof(id), "W%07d", i);
+        if (winegrowerIndex_find(&index, &list, id) != NULL) {
+            found++;
+        }
+    }
+    *findTime = bench_now() - start;
+
+    if (!bench_checkOrder(list, count) || found != count) {
+        elapsed = -1;
+    }
+    winegrowerIndex_free(&index);
+    winegrowerList_free(&list);
+
+    return elapsed;
+}
+
+int main(int argc, char** argv) {
+    double walkTime, indexTime, findTime;
+    int count, walkCount;
+    int* order;
+
+    count = (argc > 1) ? atoi(argv[1]) : BENCH_DEFAULT_WINEGROWERS;
+    walkCount = (argc > 2) ? atoi(argv[2]) : BENCH_DEFAULT_WALK;
+    if (count <= 0 || walkCount < 0 || walkCount > count) {
+        fprintf(stderr, "usage: %s [winegrowers] [winegrowers for the list walk (0-winegrowers)]\n", argv[0]);
+        return 1;
+    }
+
+    order = bench_makeOrder(count);
+    if (order == NULL) {
+        fprintf(stderr, "not enough memory\n");
+        return 1;
+    }
+
+    if (walkCount > 0) {
+        walkTime = bench_loadWalk(order, walkCount);
+        if (walkTime < 0) {
+            fprintf(stderr, "the list walk did not keep the winegrowers sorted\n");
+            free(order);
+            return 1;
+        }
+        printf("%-12s %9d winegrowers %8.3f s  %8.1f ns/insert\n", "list walk", walkCount, walkTime,
+                walkTime * 1e9 / walkCount);
+    }
+
+    indexTime = bench_loadIndex(order, count, &findTime);
+    if (indexTime < 0) {
+        fprintf(stderr, "the index did not keep the winegrowers sorted\n");
+        free(order);
+        return 1;
+    }
+    printf("%-12s %9d winegrowers %8.3f s  %8.1f ns/insert\n", "index", count, indexTime, indexTime * 1e9 / count);
+    printf("%-12s %9d winegrowers %8.3f s  %8.1f ns/find\n", "index find", count, findTime, findTime * 1e9 / count);
+
+    free(order);
+    return 0;
+}
@@ -1,4 +1,6 @@
 #include "csv.h"
+#include "csvscan.h"
+#include "parse.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -7,6 +9,7 @@
 // Initialize the tCSVData structure
 void csv_init(tCSVData* data) {
     data->count = 0;
+    data->capacity = 0;
     data->isValid = false;
     data->entries = NULL;
 }
@@ -16,61 +19,170 @@ void csv_initEntry(tCSVEntry* entry) {
     entry->numFields = 0;    
     entry->fields = NULL;
     entry->type = NULL;
+    entry->typeId = CSV_TYPE_UNKNOWN;
+    entry->lengths = NULL;
+    entry->buffer = NULL;
+}
+
+// Known entry types. All the names have a different length, so the length is a perfect hash
+#define CSV_TYPE_TABLE_SIZE 16
+static const struct {
+    const char* name;
+    tCSVEntryType type;
+} csv_typeTable[CSV_TYPE_TABLE_SIZE] = {
+    [2] = { "DO", CSV_TYPE_DO },
+    [6] = { "PERSON", CSV_TYPE_PERSON },
+    [8] = { "WEIGHING", CSV_TYPE_WEIGHING },
+    [10] = { "WINEGROWER", CSV_TYPE_WINEGROWER },
+    [13] = { "VINEYARD_PLOT", CSV_TYPE_VINEYARD_PLOT },
+};
+
+// Classify the first len characters of a type name
+tCSVEntryType csv_classifyType(const char* type, int len) {
+    if (type == NULL || len <= 0 || len >= CSV_TYPE_TABLE_SIZE || csv_typeTable[len].name == NULL) {
+        return CSV_TYPE_UNKNOWN;
+    }
+    if (memcmp(csv_typeTable[len].name, type, len) != 0) {
+        return CSV_TYPE_UNKNOWN;
+    }
+    return csv_typeTable[len].type;
+}
+
+// Build an entry from the first len characters of a CSV line and the offsets of its separators.
+// The entry owns a single block with the field pointers, the field lengths and a copy of the line
+// where each separator is replaced by '\0', so every field is a slice of that copy.
+static void csv_buildEntry(tCSVEntry* entry, const char* input, int len, const char* type, const int* separators, int numSeparators) {
+    char *text, *pStart, *pLimit;
+    int maxFields, typeLen, i;
+    bool readType = true;
+    
+    assert(entry->numFields == 0);
+    assert(entry->fields == NULL);
+    assert(input != NULL);
+    
+    // Each separator closes at most one field, plus the remaining text
+    maxFields = numSeparators + 1;
+    typeLen = (type != NULL) ? strlen(type) + 1 : 0;
+    
+    // Single allocation: [fields][lengths][line text + '\0'][type + '\0']
+    entry->buffer = (char*) malloc(maxFields * (sizeof(char*) + sizeof(int)) + (len + 1) + typeLen);
+    assert(entry->buffer != NULL);
+    entry->fields = (char**) entry->buffer;
+    entry->lengths = (int*) (entry->fields + maxFields);
+    text = (char*) (entry->lengths + maxFields);
+    memcpy(text, input, len);
+    text[len] = '\0';
+    
+    // If the type of the entry is not provided, use the first field
+    if (type != NULL) {
+        entry->type = text + len + 1;
+        memcpy(entry->type, type, typeLen);
+        entry->typeId = csv_classifyType(type, typeLen - 1);
+        readType = false;
+    }
+    
+    pStart = text;
+    pLimit = text + len;
+    for (i = 0; i < numSeparators && text + separators[i] != pStart; i++) {
+        // Terminate the field in place
+        text[separators[i]] = '\0';
+        
+        if (readType) {
+            entry->type = pStart;
+            entry->typeId = csv_classifyType(pStart, (text + separators[i]) - pStart);
+            readType = false;
+        } else {
+            entry->fields[entry->numFields] = pStart;
+            entry->lengths[entry->numFields] = (text + separators[i]) - pStart;
+            entry->numFields++;
+        }
+        
+        pStart = text + separators[i] + 1;
+    }
+    if (pStart < pLimit) {
+        
+        assert(!readType);
+        
+        entry->fields[entry->numFields] = pStart;
+        entry->lengths[entry->numFields] = pLimit - pStart;
+        entry->numFields++;
+    }
+}
+
+// Append a new empty entry to the CSV Data
+static tCSVEntry* csv_appendEntry(tCSVData* data) {
+    // Grow geometrically to avoid a reallocation per entry
+    if (data->count == data->capacity) {
+        data->capacity = (data->capacity == 0) ? 1 : data->capacity * 2;
+        data->entries = (tCSVEntry*) realloc(data->entries, data->capacity * sizeof(tCSVEntry));
+        assert(data->entries != NULL);
+    }
+    data->count++;
+    csv_initEntry(&(data->entries[data->count-1]));
+    
+    return &(data->entries[data->count-1]);
 }
 
 // Add a new entry to the CSV Data
 void csv_addStrEntry(tCSVData* data, const char* entry, const char* type) {
     assert( data != NULL );
     assert( entry != NULL );
-    data->count++;
-    if (data->count == 1) {
-        data->entries = (tCSVEntry*) malloc(sizeof(tCSVEntry));
-    } else {
-        data->entries = (tCSVEntry*) realloc(data->entries, data->count * sizeof(tCSVEntry));
-    }
-    csv_initEntry(&(data->entries[data->count-1]));
-    csv_parseEntry(&(data->entries[data->count-1]), entry, type);
+    csv_parseEntry(csv_appendEntry(data), entry, type);
+}
+
+// Add a new entry to the CSV Data from the first len characters of a line
+void csv_addEntry(tCSVData* data, const char* entry, int len, const char* type) {
+    assert( data != NULL );
+    assert( entry != NULL );
+    csv_parseEntryN(csv_appendEntry(data), entry, len, type);
 }
 
 // Parse the contents of a CSV file
 void csv_parse(tCSVData* data, const char* input, const char* type) {
-    const char *pStart, *pEnd;
-    char *line;
-    int len;
+    tCSVScan scan;
+    int len, lineStart, firstSeparator, i, j;
     
     assert(data->count == 0);
     assert(data->entries == NULL);
     assert(!data->isValid);
     
-    pStart = input;
-    pEnd = strchr(pStart, '\n');    
-    while(pEnd != NULL && pEnd != pStart) {
-        len = pEnd - pStart + 1;
-        line = (char*) malloc(len * sizeof(char));
-        memset(line, 0, len * sizeof(char));
-        strncpy(line, pStart, pEnd - pStart);
+    // Find all the separators and line ends in a single pass
+    len = strlen(input);
+    csvScan_init(&scan);
+    csvScan_run(&scan, input, len);
+    
+    lineStart = 0;
+    firstSeparator = 0;
+    for (i = 0; i < scan.count; i++) {
+        if (input[scan.offsets[i]] != '\n') {
+            continue;
+        }
+        // An empty line ends the line by line parsing
+        if (scan.offsets[i] == lineStart) {
+            break;
+        }
+        // Make the separator offsets relative to the start of the line
+        for (j = firstSeparator; j < i; j++) {
+            scan.offsets[j] -= lineStart;
+        }
         // Add the new entry line
-        csv_addStrEntry(data, line, type);
-        free(line);
-        pStart = pEnd + 1;
-        pEnd = strchr(pStart, '\n');
+        csv_buildEntry(csv_appendEntry(data), input + lineStart, scan.offsets[i] - lineStart, type, scan.offsets + firstSeparator, i - firstSeparator);
+        
+        lineStart = scan.offsets[i] + 1;
+        firstSeparator = i + 1;
     }
-    pEnd = strchr(pStart, '\0');
-    if (pEnd != NULL && pEnd != pStart) {
-        len = pEnd - pStart + 1;
-        line = (char*) malloc(len * sizeof(char));
-        memset(line, 0, len * sizeof(char));
-        strncpy(line, pStart, pEnd - pStart);
-        data->count++;
-        if (data->count == 1) {
-            data->entries = (tCSVEntry*) malloc(sizeof(tCSVEntry));
+    // The remaining text is added as the last entry
+    if (lineStart < len) {
+        if (i == scan.count) {
+            for (j = firstSeparator; j < i; j++) {
+                scan.offsets[j] -= lineStart;
+            }
+            csv_buildEntry(csv_appendEntry(data), input + lineStart, len - lineStart, type, scan.offsets + firstSeparator, i - firstSeparator);
         } else {
-            data->entries = (tCSVEntry*) realloc(data->entries, data->count * sizeof(tCSVEntry));
+            csv_addEntry(data, input + lineStart, len - lineStart, type);
         }
-        csv_initEntry(&(data->entries[data->count-1]));
-        csv_parseEntry(&(data->entries[data->count-1]), line, type);
-        free(line);
     }
+    csvScan_free(&scan);
     data->isValid = true;
 }
 
@@ -102,63 +214,33 @@ void csv_printEntry(tCSVEntry entry) {
 
 // Parse the contents of a CSV line
 void csv_parseEntry(tCSVEntry* entry, const char* input, const char* type) {
-    const char *pStart, *pEnd;    
-    int len;
-    bool readType = true;
+    assert(input != NULL);
     
-    assert(entry->numFields == 0);
-    assert(entry->fields == NULL);
+    csv_parseEntryN(entry, input, strlen(input), type);
+}
+
+// Parse the first len characters of a CSV line
+void csv_parseEntryN(tCSVEntry* entry, const char* input, int len, const char* type) {
+    int storage[CSV_SCAN_LOCAL_OFFSETS];
+    tCSVScan scan;
+    int i, numSeparators;
     
-    // If the type of the entry is not provided, use the first field
-    if(type != NULL) {
-        len = strlen(type) + 1;
-        entry->type = (char*) malloc(len * sizeof(char));
-        memset(entry->type, 0, len * sizeof(char));
-        strncpy(entry->type, type, len);
-        readType = false;
-    }        
-    pStart = input;
-    pEnd = strchr(pStart, ';');    
-    while(pEnd != NULL && pEnd != pStart) {        
-        // Get the length of the field
-        len = pEnd - pStart + 1;
-        
-        if(readType) {
-            entry->type = (char*) malloc(len * sizeof(char));
-            memset(entry->type, 0, len * sizeof(char));
-            strncpy(entry->type, pStart, pEnd - pStart);
-            readType = false;
-        } else {
-            entry->numFields++;
-            if (entry->numFields == 1) {
-                entry->fields = (char**) malloc(sizeof(char*));
-            } else {
-                entry->fields = (char**) realloc(entry->fields, entry->numFields * sizeof(char*));
-            }                
-            entry->fields[entry->numFields - 1] = (char*) malloc(len * sizeof(char));
-            memset(entry->fields[entry->numFields - 1], 0, len * sizeof(char));
-            strncpy(entry->fields[entry->numFields - 1], pStart, pEnd - pStart);
+    assert(input != NULL);
+    assert(len >= 0);
+    
+    // Find the separators of the line. Usual lines fit in the local storage
+    csvScan_initWith(&scan, storage, CSV_SCAN_LOCAL_OFFSETS);
+    csvScan_run(&scan, input, len);
+    
+    // Line ends inside the line are part of the fields
+    numSeparators = 0;
+    for (i = 0; i < scan.count; i++) {
+        if (input[scan.offsets[i]] == ';') {
+            scan.offsets[numSeparators++] = scan.offsets[i];
         }
-        
-        pStart = pEnd + 1;
-        pEnd = strchr(pStart, ';');
-    }
-    pEnd = strchr(pStart, '\0');
-    if (pEnd != NULL && pEnd != pStart) {
-        
-        assert(!readType);
-        
-        entry->numFields++;
-        if (entry->numFields == 1) {
-            entry->fields = (char**) malloc(sizeof(char*));
-        } else {
-            entry->fields = (char**) realloc(entry->fields, entry->numFields * sizeof(char*));
-        }        
-        len = pEnd - pStart + 1;
-        entry->fields[entry->numFields - 1] = (char*) malloc(len * sizeof(char));
-        memset(entry->fields[entry->numFields - 1], 0, len * sizeof(char));
-        strncpy(entry->fields[entry->numFields - 1], pStart, pEnd - pStart);
     }
+    csv_buildEntry(entry, input, len, type, scan.offsets, numSeparators);
+    csvScan_free(&scan);
 }
 
 // Get the number of entries
@@ -179,18 +261,9 @@ void csv_free(tCSVData* data) {
 
 // Remove all data from structure
 void csv_freeEntry(tCSVEntry* entry) {
-    int i;
-    
-    if(entry->fields != NULL) {
-        for(i = 0; i < entry->numFields; i++) {
-            free(entry->fields[i]);
-            entry->fields[i] = NULL;
-        }
-        
-        free(entry->fields);
-    }
-    if(entry->type != NULL) {
-        free(entry->type);
+    // Type and fields are slices of the entry block
+    if(entry->buffer != NULL) {
+        free(entry->buffer);
     }
     csv_initEntry(entry);
 }
@@ -205,6 +278,11 @@ const char* csv_getType(tCSVEntry* entry) {
     return (const char*)entry->type;
 }
 
+// Get the type of information contained in the entry, classified when the entry was parsed
+tCSVEntryType csv_getTypeId(tCSVEntry* entry) {
+    return entry->typeId;
+}
+
 // Get an entry from the CSV data
 tCSVEntry* csv_getEntry(tCSVData data, int position) {
     return &(data.entries[position]);
@@ -217,18 +295,50 @@ int csv_numFields(tCSVEntry entry) {
 
 // Get a field from the given entry as integer
 int csv_getAsInteger(tCSVEntry entry, int position) {
-    return atoi(entry.fields[position]);
+    int value;
+    
+    parse_integer(entry.fields[position], entry.lengths[position], &value);
+    return value;
+}
+
+// Get a field from the given entry as integer. Return false if the field is not a valid integer
+bool csv_tryGetAsInteger(tCSVEntry entry, int position, int* value) {
+    return parse_integer(entry.fields[position], entry.lengths[position], value);
 }
 
 // Get a field from the given entry as string
 void csv_getAsString(tCSVEntry entry, int position, char* buffer, int length) {
-    memset(buffer, 0, length);
-    strncpy(buffer, entry.fields[position], length - 1);
+    int len;
+    
+    len = entry.lengths[position];
+    if (len > length - 1) {
+        len = length - 1;
+    }
+    memcpy(buffer, entry.fields[position], len);
+    memset(buffer + len, 0, length - len);
+}
+
+// Get the length of a field from the given entry
+int csv_getFieldLength(tCSVEntry entry, int position) {
+    return entry.lengths[position];
 }
 
 // Get a field from the given entry as integer
 float csv_getAsReal(tCSVEntry entry, int position) {
-    return atof(entry.fields[position]);
+    double value;
+    
+    parse_double(entry.fields[position], entry.lengths[position], &value);
+    return value;
+}
+
+// Get a field from the given entry as real. Return false if the field is not a valid decimal number
+bool csv_tryGetAsReal(tCSVEntry entry, int position, float* value) {
+    double result;
+    bool valid;
+    
+    valid = parse_double(entry.fields[position], entry.lengths[position], &result);
+    *value = result;
+    return valid;
 }
 
 // Compare if two entries are the same
@@ -4,17 +4,32 @@
 #include <stdbool.h>
 #define CSV_SEPARATOR_CHAR ;
 
-// Store one entry from a CSV file
+// Types of entry recognized when a CSV line is parsed
+typedef enum _tCSVEntryType {
+    CSV_TYPE_UNKNOWN = 0,
+    CSV_TYPE_PERSON,
+    CSV_TYPE_WINEGROWER,
+    CSV_TYPE_VINEYARD_PLOT,
+    CSV_TYPE_DO,
+    CSV_TYPE_WEIGHING,
+    CSV_NUM_TYPES
+} tCSVEntryType;
+
+// Store one entry from a CSV file. The type and the fields are slices of a single block owned by the entry
 typedef struct _tCSVEntry {
     int numFields;
     char* type;
-    char** fields;    
+    tCSVEntryType typeId;
+    char** fields;
+    int* lengths;
+    char* buffer;
 } tCSVEntry;
 
 // Store the content of a CSV file
 typedef struct _tCSVData {
     tCSVEntry *entries;
     int count;
+    int capacity;
     bool isValid;
 } tCSVData;
 
@@ -30,6 +45,9 @@ void csv_parse(tCSVData* data, const char* input, const char* type);
 // Add a new entry to the CSV Data
 void csv_addStrEntry(tCSVData* data, const char* entry, const char* type);
 
+// Add a new entry to the CSV Data from the first len characters of a line
+void csv_addEntry(tCSVData* data, const char* entry, int len, const char* type);
+
 // Print the content of the CSV data structure
 void csv_print(tCSVData data);
 
@@ -39,6 +57,9 @@ void csv_printEntry(tCSVEntry entry);
 // Parse the contents of a CSV line   "f1;f2;f3" =>  field_0 = f1, field_1 = f2, field_2 = f3
 void csv_parseEntry(tCSVEntry* entry, const char* input, const char* type);
 
+// Parse the first len characters of a CSV line. The input does not need to be null terminated
+void csv_parseEntryN(tCSVEntry* entry, const char* input, int len, const char* type);
+
 // Get the number of entries
 bool csv_isValid(tCSVData data);
 
@@ -54,6 +75,12 @@ int csv_numEntries(tCSVData data);
 // Get the type of information contained in the entry
 const char* csv_getType(tCSVEntry* entry);
 
+// Get the type of information contained in the entry, classified when the entry was parsed
+tCSVEntryType csv_getTypeId(tCSVEntry* entry);
+
+// Classify the first len characters of a type name
+tCSVEntryType csv_classifyType(const char* type, int len);
+
 // Get an entry from the CSV data
 tCSVEntry* csv_getEntry(tCSVData data, int position);
 
@@ -63,12 +90,21 @@ int csv_numFields(tCSVEntry entry);
 // Get a field from the given entry as integer
 int csv_getAsInteger(tCSVEntry entry, int position);
 
+// Get a field from the given entry as integer. Return false if the field is not a valid integer
+bool csv_tryGetAsInteger(tCSVEntry entry, int position, int* value);
+
 // Get a field from the given entry as string. The value is copied to the provided buffer with provided maximum length
 void csv_getAsString(tCSVEntry entry, int position, char* buffer, int length);
 
+// Get the length of a field from the given entry
+int csv_getFieldLength(tCSVEntry entry, int position);
+
 // Get a field from the given entry as integer
 float csv_getAsReal(tCSVEntry entry, int position);
 
+// Get a field from the given entry as real. Return false if the field is not a valid decimal number
+bool csv_tryGetAsReal(tCSVEntry entry, int position, float* value);
+
 // Compare if two entries are the same
 bool csv_equalsEntry(tCSVEntry entry1, tCSVEntry entry2);
 
@@ -0,0 +1,187 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "csvreader.h"
+
+// Open a file for reading
+tApiError csvReader_open(tCSVReader* reader, const char* filename) {
+    struct stat info;
+    void* map;
+
+    assert(reader != NULL);
+    assert(filename != NULL);
+
+    reader->data = NULL;
+    reader->size = 0;
+    reader->capacity = 0;
+    reader->pos = 0;
+    reader->mapped = false;
+    reader->borrowed = false;
+    reader->eof = false;
+    reader->failed = false;
+
+    reader->fd = open(filename, O_RDONLY);
+    if (reader->fd < 0) {
+        return E_FILE_NOT_FOUND;
+    }
+
+    if (fstat(reader->fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        // Empty regular file
+        if (info.st_size == 0) {
+            reader->eof = true;
+            return E_SUCCESS;
+        }
+
+        // Map the whole file. Lines are returned as slices of the mapping
+        map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, reader->fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, info.st_size, MADV_SEQUENTIAL);
+            reader->data = (char*) map;
+            reader->size = info.st_size;
+            reader->capacity = info.st_size;
+            reader->mapped = true;
+            reader->eof = true;
+            return E_SUCCESS;
+        }
+    }
+
+    // Pipes and files that can not be mapped are read in large blocks
+    reader->data = (char*) malloc(CSV_READER_BLOCK_SIZE);
+    if (reader->data == NULL) {
+        close(reader->fd);
+        reader->fd = -1;
+        return E_MEMORY_ERROR;
+    }
+    reader->capacity = CSV_READER_BLOCK_SIZE;
+
+    return E_SUCCESS;
+}
+
+// Read the lines of a memory buffer
+void csvReader_openBuffer(tCSVReader* reader, const char* data, size_t size) {
+    assert(reader != NULL);
+    assert(data != NULL || size == 0);
+
+    reader->fd = -1;
+    reader->data = (char*) data;
+    reader->size = size;
+    reader->capacity = size;
+    reader->pos = 0;
+    reader->mapped = false;
+    reader->borrowed = true;
+    reader->eof = true;
+    reader->failed = false;
+}
+
+// Read the next block of the file, keeping the data not consumed yet
+static void csvReader_fill(tCSVReader* reader) {
+    ssize_t n;
+    char* data;
+
+    // Move the pending data to the beginning of the buffer
+    if (reader->pos > 0) {
+        memmove(reader->data, reader->data + reader->pos, reader->size - reader->pos);
+        reader->size -= reader->pos;
+        reader->pos = 0;
+    }
+
+    // The pending line does not fit in the buffer
+    if (reader->size == reader->capacity) {
+        data = (char*) realloc(reader->data, reader->capacity * 2);
+        assert(data != NULL);
+        reader->data = data;
+        reader->capacity *= 2;
+    }
+
+    do {
+        n = read(reader->fd, reader->data + reader->size, reader->capacity - reader->size);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0) {
+        // Stop reading. The pending data is not returned, as it may be an incomplete line
+        reader->failed = true;
+        reader->eof = true;
+    } else if (n == 0) {
+        reader->eof = true;
+    } else {
+        reader->size += n;
+    }
+}
+
+// Get the next non empty line, without the line end
+bool csvReader_nextLine(tCSVReader* reader, const char** line, int* len) {
+    char *pStart, *pEnd;
+    size_t length;
+
+    assert(reader != NULL);
+    assert(line != NULL);
+    assert(len != NULL);
+
+    while (true) {
+        pStart = reader->data + reader->pos;
+        pEnd = (reader->pos < reader->size) ? memchr(pStart, '\n', reader->size - reader->pos) : NULL;
+
+        if (pEnd != NULL) {
+            length = pEnd - pStart;
+            reader->pos += length + 1;
+        } else if (!reader->eof) {
+            // The line continues in the next block
+            csvReader_fill(reader);
+            continue;
+        } else if (reader->failed) {
+            return false;
+        } else if (reader->pos < reader->size) {
+            // Last line without line end
+            length = reader->size - reader->pos;
+            reader->pos = reader->size;
+        } else {
+            return false;
+        }
+
+        // Cut the line at the first carriage return, as Windows line ends have one
+        pEnd = (length > 0) ? memchr(pStart, '\r', length) : NULL;
+        if (pEnd != NULL) {
+            length = pEnd - pStart;
+        }
+
+        // Skip empty lines
+        if (length > 0) {
+            *line = pStart;
+            *len = (int) length;
+            return true;
+        }
+    }
+}
+
+// Check if reading the file failed
+bool csvReader_failed(const tCSVReader* reader) {
+    assert(reader != NULL);
+
+    return reader->failed;
+}
+
+// Close the file and release the used memory
+void csvReader_close(tCSVReader* reader) {
+    assert(reader != NULL);
+
+    if (reader->data != NULL && !reader->borrowed) {
+        if (reader->mapped) {
+            munmap(reader->data, reader->capacity);
+        } else {
+            free(reader->data);
+        }
+        reader->data = NULL;
+    }
+    if (reader->fd >= 0) {
+        close(reader->fd);
+        reader->fd = -1;
+    }
+    reader->size = 0;
+    reader->capacity = 0;
+    reader->pos = 0;
+}
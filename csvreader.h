@@ -0,0 +1,41 @@
+#ifndef __CSVREADER_H__
+#define __CSVREADER_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "error.h"
+
+// Size of the blocks read when the file can not be mapped in memory
+#define CSV_READER_BLOCK_SIZE (1024 * 1024)
+
+// Read a CSV file line by line, with no limit in the length of the lines.
+// The file is mapped in memory when possible, otherwise it is read in large blocks
+typedef struct _tCSVReader {
+    int fd;
+    char* data;
+    size_t size;
+    size_t capacity;
+    size_t pos;
+    bool mapped;
+    bool borrowed;
+    bool eof;
+    bool failed;
+} tCSVReader;
+
+// Open a file for reading
+tApiError csvReader_open(tCSVReader* reader, const char* filename);
+
+// Read the lines of a memory buffer. The buffer is not copied and must outlive the reader
+void csvReader_openBuffer(tCSVReader* reader, const char* data, size_t size);
+
+// Get the next non empty line, up to the first line end or carriage return. The line points to the reader
+// data and is valid until the next call. Return false when there are no more lines or the file can not be read
+bool csvReader_nextLine(tCSVReader* reader, const char** line, int* len);
+
+// Check if reading the file failed. Then the lines returned so far are not the whole file
+bool csvReader_failed(const tCSVReader* reader);
+
+// Close the file and release the used memory
+void csvReader_close(tCSVReader* reader);
+
+#endif
@@ -0,0 +1,200 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "csvscan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CSV_SCAN_X86
+#endif
+
+// Number of bytes processed between two checks of the available space
+#define CSV_SCAN_BLOCK 32
+
+typedef void (*tCSVScanFunc)(tCSVScan* scan, const char* buffer, int len);
+
+// Initialize the scan structure with no storage
+void csvScan_init(tCSVScan* scan) {
+    assert(scan != NULL);
+
+    scan->offsets = NULL;
+    scan->count = 0;
+    scan->capacity = 0;
+    scan->owned = true;
+}
+
+// Initialize the scan structure using the storage provided by the caller
+void csvScan_initWith(tCSVScan* scan, int* storage, int capacity) {
+    assert(scan != NULL);
+    assert(storage != NULL);
+
+    scan->offsets = storage;
+    scan->count = 0;
+    scan->capacity = capacity;
+    scan->owned = false;
+}
+
+// Remove all data from structure
+void csvScan_free(tCSVScan* scan) {
+    assert(scan != NULL);
+
+    if (scan->owned && scan->offsets != NULL) {
+        free(scan->offsets);
+    }
+    csvScan_init(scan);
+}
+
+// Make room for, at least, another block of offsets
+static void csvScan_reserve(tCSVScan* scan) {
+    int capacity;
+    int* offsets;
+
+    if (scan->count + CSV_SCAN_BLOCK <= scan->capacity) {
+        return;
+    }
+
+    // Grow geometrically to keep the number of reallocations low
+    capacity = scan->capacity * 2;
+    if (capacity < scan->count + CSV_SCAN_BLOCK) {
+        capacity = scan->count + CSV_SCAN_BLOCK;
+    }
+
+    if (scan->owned) {
+        offsets = (int*) realloc(scan->offsets, capacity * sizeof(int));
+    } else {
+        // Move the offsets from the caller storage to the heap
+        offsets = (int*) malloc(capacity * sizeof(int));
+        assert(offsets != NULL);
+        memcpy(offsets, scan->offsets, scan->count * sizeof(int));
+    }
+    assert(offsets != NULL);
+
+    scan->offsets = offsets;
+    scan->capacity = capacity;
+    scan->owned = true;
+}
+
+// Scan the bytes in [start, len) one by one
+static void csvScan_tail(tCSVScan* scan, const char* buffer, int start, int len) {
+    int i;
+
+    for (i = start; i < len; i++) {
+        if (buffer[i] == ';' || buffer[i] == '\n') {
+            scan->offsets[scan->count++] = i;
+        }
+    }
+}
+
+// Scalar version of csvScan_run
+void csvScan_runScalar(tCSVScan* scan, const char* buffer, int len) {
+    int i, end;
+
+    assert(scan != NULL);
+    assert(buffer != NULL || len == 0);
+
+    scan->count = 0;
+    for (i = 0; i < len; i += CSV_SCAN_BLOCK) {
+        csvScan_reserve(scan);
+        end = (i + CSV_SCAN_BLOCK < len) ? i + CSV_SCAN_BLOCK : len;
+        csvScan_tail(scan, buffer, i, end);
+    }
+}
+
+#ifdef CSV_SCAN_X86
+
+// Append the offsets of the bits set in mask, relative to base
+static inline void csvScan_emit(tCSVScan* scan, unsigned int mask, int base) {
+    while (mask != 0) {
+        scan->offsets[scan->count++] = base + __builtin_ctz(mask);
+        // Clear the lowest bit set
+        mask &= mask - 1;
+    }
+}
+
+// SSE2 version: compare 16 bytes at once with both delimiters
+__attribute__((target("sse2")))
+static void csvScan_runSSE2(tCSVScan* scan, const char* buffer, int len) {
+    __m128i separator, newLine, chunk;
+    unsigned int mask;
+    int i;
+
+    separator = _mm_set1_epi8(';');
+    newLine = _mm_set1_epi8('\n');
+
+    scan->count = 0;
+    for (i = 0; i + 16 <= len; i += 16) {
+        if ((i % CSV_SCAN_BLOCK) == 0) {
+            csvScan_reserve(scan);
+        }
+        chunk = _mm_loadu_si128((const __m128i*) (buffer + i));
+        mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, separator), _mm_cmpeq_epi8(chunk, newLine)));
+        csvScan_emit(scan, mask, i);
+    }
+    csvScan_reserve(scan);
+    csvScan_tail(scan, buffer, i, len);
+}
+
+// AVX2 version: compare 32 bytes at once with both delimiters
+__attribute__((target("avx2")))
+static void csvScan_runAVX2(tCSVScan* scan, const char* buffer, int len) {
+    __m256i separator, newLine, chunk;
+    unsigned int mask;
+    int i;
+
+    separator = _mm256_set1_epi8(';');
+    newLine = _mm256_set1_epi8('\n');
+
+    scan->count = 0;
+    for (i = 0; i + 32 <= len; i += 32) {
+        csvScan_reserve(scan);
+        chunk = _mm256_loadu_si256((const __m256i*) (buffer + i));
+        mask = (unsigned int) _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, separator), _mm256_cmpeq_epi8(chunk, newLine)));
+        csvScan_emit(scan, mask, i);
+    }
+    csvScan_reserve(scan);
+    csvScan_tail(scan, buffer, i, len);
+}
+
+#endif
+
+// Select the best implementation for the running CPU
+static tCSVScanFunc csvScan_select(const char** name) {
+#ifdef CSV_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return csvScan_runAVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        *name = "sse2";
+        return csvScan_runSSE2;
+    }
+#endif
+    *name = "scalar";
+    return csvScan_runScalar;
+}
+
+static tCSVScanFunc csvScan_func = NULL;
+static const char* csvScan_name = NULL;
+static pthread_once_t csvScan_once = PTHREAD_ONCE_INIT;
+
+// Select the implementation once, even if several threads parse at the same time
+static void csvScan_setup() {
+    csvScan_func = csvScan_select(&csvScan_name);
+}
+
+// Find all the separators and line ends of the first len characters of the buffer in a single pass
+void csvScan_run(tCSVScan* scan, const char* buffer, int len) {
+    assert(scan != NULL);
+    assert(buffer != NULL || len == 0);
+
+    pthread_once(&csvScan_once, csvScan_setup);
+    csvScan_func(scan, buffer, len);
+}
+
+// Name of the implementation used by csvScan_run
+const char* csvScan_implementation() {
+    pthread_once(&csvScan_once, csvScan_setup);
+    return csvScan_name;
+}
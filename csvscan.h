@@ -0,0 +1,36 @@
+#ifndef __CSVSCAN_H__
+#define __CSVSCAN_H__
+
+#include <stdbool.h>
+
+// Number of offsets that fit in the storage provided by the caller before using the heap
+#define CSV_SCAN_LOCAL_OFFSETS 32
+
+// Store the offsets of all the field separators (';') and line ends ('\n') of a buffer
+typedef struct _tCSVScan {
+    int* offsets;
+    int count;
+    int capacity;
+    bool owned;
+} tCSVScan;
+
+// Initialize the scan structure with no storage
+void csvScan_init(tCSVScan* scan);
+
+// Initialize the scan structure using the storage provided by the caller. It moves to the heap if it gets full
+void csvScan_initWith(tCSVScan* scan, int* storage, int capacity);
+
+// Remove all data from structure
+void csvScan_free(tCSVScan* scan);
+
+// Find all the separators and line ends of the first len characters of the buffer in a single pass.
+// The best available implementation (AVX2, SSE2 or scalar) is selected at runtime
+void csvScan_run(tCSVScan* scan, const char* buffer, int len);
+
+// Scalar version of csvScan_run
+void csvScan_runScalar(tCSVScan* scan, const char* buffer, int len);
+
+// Name of the implementation used by csvScan_run
+const char* csvScan_implementation();
+
+#endif
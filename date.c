@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <string.h>
 #include "date.h"
+#include "parse.h"
 
 // Copy a date from src to dst
 void date_cpy(tDate* dst, tDate src)
@@ -42,6 +43,34 @@ int date_cmp(tDate date1, tDate date2) {
     return 0;
 }
 
+// Pack a date in an integer. Packed valid dates keep the order of date_cmp
+tPackedDate date_pack(tDate date) {
+    // Month and day use the low bits, so any date stays in the range of its year
+    return date.year * DATE_PACK_YEAR + (date.month & (DATE_PACK_YEAR / DATE_PACK_MONTH - 1)) * DATE_PACK_MONTH
+        + (date.day & (DATE_PACK_MONTH - 1));
+}
+
+// Get the date of a packed value
+void date_unpack(tDate* date, tPackedDate packed) {
+    // Check output data
+    assert(date != NULL);
+    
+    date->day = packed & (DATE_PACK_MONTH - 1);
+    date->month = (packed & (DATE_PACK_YEAR - 1)) / DATE_PACK_MONTH;
+    date->year = date_packedYear(packed);
+}
+
+// Get the year of a packed date
+int date_packedYear(tPackedDate packed) {
+    // Remove the month and day first, so negative years are not rounded towards zero
+    return (packed - (packed & (DATE_PACK_YEAR - 1))) / DATE_PACK_YEAR;
+}
+
+// Compare two packed dates and return -1 if packed1<packed2, 0 if equals and 1 if packed1>packed2.
+int date_cmpPacked(tPackedDate packed1, tPackedDate packed2) {
+    return (packed1 > packed2) - (packed1 < packed2);
+}
+
 // Parse a tDate from string information
 void date_parse(tDate* date, const char* text)
 {
@@ -53,7 +82,47 @@ void date_parse(tDate* date, const char* text)
     assert(strlen(text) == DATE_LENGTH);
  
     // Parse the input date
+    date_tryParse(date, text);
+}
+
+// Parse a tDate from string information. Return false if the text does not have the format dd/mm/yyyy
+bool date_tryParse(tDate* date, const char* text)
+{
+    // Check output data
+    assert(date != NULL);
+    
+    // Check input date
+    assert(text != NULL);
+    
+    if (parse_date(text, strlen(text), &(date->day), &(date->month), &(date->year))) {
+        return true;
+    }
+    
+    // Keep the lenient behaviour for dates with other formats
     sscanf(text, "%d/%d/%d", &(date->day), &(date->month), &(date->year));
+    return false;
+}
+
+// Parse a packed date from string information. Return false if the text does not have the format dd/mm/yyyy
+bool date_tryParsePacked(tPackedDate* packed, const char* text)
+{
+    tDate date;
+    bool valid;
+    
+    // Check output data
+    assert(packed != NULL);
+    
+    // Check input date
+    assert(text != NULL);
+    
+    // Dates with other formats are parsed as date_tryParse does
+    date.day = 0;
+    date.month = 0;
+    date.year = 0;
+    valid = date_tryParse(&date, text);
+    *packed = date_pack(date);
+    
+    return valid;
 }
 
 // Parse a tDateTime from string information
@@ -70,34 +139,22 @@ void dateTime_parse(tDateTime* dateTime, const char* date, const char* time) {
     assert(strlen(time) == 5);
     
     // Parse the input date
-    sscanf(date, "%d/%d/%d", &(dateTime->date.day), &(dateTime->date.month), &(dateTime->date.year));
+    date_tryParse(&(dateTime->date), date);
     
     // Parse the input time
-    sscanf(time, "%d:%d", &(dateTime->time.hour), &(dateTime->time.minutes));
+    if (!parse_time(time, strlen(time), &(dateTime->time.hour), &(dateTime->time.minutes))) {
+        sscanf(time, "%d:%d", &(dateTime->time.hour), &(dateTime->time.minutes));
+    }
 }
 
 // Compare two tDateTime structures and return -1 if dateTime1<dateTime2, 0 if equals and 1 if dateTime1>dateTime2.
 int dateTime_cmp(tDateTime dateTime1, tDateTime dateTime2) {    
-    // Checkl year
-    if (dateTime1.date.year < dateTime2.date.year) {
-        return -1;
-    }
-    if (dateTime1.date.year > dateTime2.date.year) {
-        return 1;
-    }
-    // Check month
-    if (dateTime1.date.month < dateTime2.date.month) {
-        return -1;
-    }
-    if (dateTime1.date.month > dateTime2.date.month) {
-        return 1;
-    }  
-    // Check day
-    if (dateTime1.date.day < dateTime2.date.day) {
-        return -1;
-    }
-    if (dateTime1.date.day > dateTime2.date.day) {
-        return 1;
+    int cmp;
+    
+    // Check date
+    cmp = date_cmp(dateTime1.date, dateTime2.date);
+    if (cmp != 0) {
+        return cmp;
     }
     // Check hour
     if (dateTime1.time.hour < dateTime2.time.hour) {
@@ -5,12 +5,19 @@
 // Length of the date
 #define DATE_LENGTH 10
 
+// Range of packed values of each year and month. Packed dates of year y are in [y * DATE_PACK_YEAR, (y + 1) * DATE_PACK_YEAR)
+#define DATE_PACK_YEAR 512
+#define DATE_PACK_MONTH 32
+
 typedef struct _tDate {    
     int day; 
     int month;
     int year;
 } tDate;
 
+// Date packed in a single integer: year * DATE_PACK_YEAR + month * DATE_PACK_MONTH + day
+typedef int tPackedDate;
+
 typedef struct _tTime {
     int hour; 
     int minutes;
@@ -27,9 +34,27 @@ void date_cpy(tDate* dst, tDate src);
 // Compare two tDate structures and return -1 if date1<date2, 0 if equals and 1 if date1>date2.
 int date_cmp(tDate date1, tDate date2);
 
+// Pack a date in an integer. Packed valid dates keep the order of date_cmp
+tPackedDate date_pack(tDate date);
+
+// Get the date of a packed value
+void date_unpack(tDate* date, tPackedDate packed);
+
+// Get the year of a packed date
+int date_packedYear(tPackedDate packed);
+
+// Compare two packed dates and return -1 if packed1<packed2, 0 if equals and 1 if packed1>packed2.
+int date_cmpPacked(tPackedDate packed1, tPackedDate packed2);
+
 // Parse a tDate from string information
 void date_parse(tDate* date, const char* text);
 
+// Parse a tDate from string information. Return false if the text does not have the format dd/mm/yyyy
+bool date_tryParse(tDate* date, const char* text);
+
+// Parse a packed date from string information. Return false if the text does not have the format dd/mm/yyyy
+bool date_tryParsePacked(tPackedDate* packed, const char* text);
+
 // Parse a tDateTime from string information
 void dateTime_parse(tDateTime* dateTime, const char* date, const char* time);
 
@@ -1,7 +1,27 @@
 #include "assert.h"
 #include "string.h"
 #include "stdlib.h"
+#include "stdint.h"
 #include "do.h"
+#include "arena.h"
+
+// Check if a code fits in a DO
+bool do_checkCode(const char* code)
+{
+    // Preconditions
+    assert(code != NULL);
+    
+    return code[0] != '\0' && strnlen(code, DO_CODE_LENGTH + 1) <= DO_CODE_LENGTH;
+}
+
+// Copy a code that fits into a DO, padding it with '\0'
+static void do_setCode(tDO* DO, const char* code)
+{
+    assert(do_checkCode(code));
+    
+    memset(DO->code, 0, sizeof(DO->code));
+    memcpy(DO->code, code, strlen(code));
+}
 
 // Initialize to NULL all pointers of a DO
 void do_initEmpty(tDO* DO)
@@ -9,11 +29,14 @@ void do_initEmpty(tDO* DO)
     // Preconditions
     assert(DO != NULL);
     
-    DO->code = NULL;
+    memset(DO->code, 0, sizeof(DO->code));
     DO->name = NULL;
     
     winegrowerList_init(&(DO->winegrowers));
+    winegrowerIndex_init(&(DO->winegrowerIndex));
     vineyardplotData_init(&(DO->vineyards));
+    weighingStore_init(&(DO->weighings));
+    weighingTotals_init(&(DO->totals));
 }
 
 // Initialize a DO
@@ -24,24 +47,25 @@ tApiError do_init(tDO* DO, const char* code, const char* name, double avgCropFie
     assert(code != NULL);
     assert(name != NULL);
     
-    DO->code = (char*)malloc(sizeof(char) * (strlen(code) + 1));
-    
-    if (DO->code == NULL) {
-        return E_MEMORY_ERROR;
+    if (!do_checkCode(code)) {
+        return E_INVALID_ENTRY_FORMAT;
     }
+    do_setCode(DO, code);
     
-    DO->name = (char*)malloc(sizeof(char) * (strlen(name) + 1));
+    DO->name = (char*)arena_malloc(sizeof(char) * (strlen(name) + 1));
     
     if (DO->name == NULL) {
         return E_MEMORY_ERROR;
     }
     
-    strcpy(DO->code, code);
     strcpy(DO->name, name);
     DO->avgCropField = avgCropField;
     
     winegrowerList_init(&(DO->winegrowers));
+    winegrowerIndex_init(&(DO->winegrowerIndex));
     vineyardplotData_init(&(DO->vineyards));
+    weighingStore_init(&(DO->weighings));
+    weighingTotals_init(&(DO->totals));
     
     return E_SUCCESS;
 }
@@ -61,18 +85,20 @@ void do_free(tDO* DO)
     // Preconditions
     assert(DO != NULL);
     
-    if (DO->code != NULL) {
-        free(DO->code);
-        DO->code = NULL;
-    }
+    memset(DO->code, 0, sizeof(DO->code));
     
     if (DO->name != NULL) {
-        free(DO->name);
+        arena_free(DO->name);
         DO->name = NULL;
     }
     
+    winegrowerIndex_free(&(DO->winegrowerIndex));
     winegrowerList_free(&(DO->winegrowers));
     vineyardplotData_free(&(DO->vineyards));
+    
+    // The store and the totals only have the weighings released above
+    weighingStore_free(&(DO->weighings));
+    weighingTotals_free(&(DO->totals));
 }
 
 // Initialize a DO data
@@ -83,6 +109,9 @@ void doData_init(tDOData* data)
     
     data->elems = NULL;
     data->count = 0;
+    data->capacity = 0;
+    data->index = NULL;
+    data->indexCapacity = 0;
 }
 
 // Release a DO data
@@ -98,35 +127,164 @@ void doData_free(tDOData* data)
             do_free(&(data->elems[i]));
         }
         
-        free(data->elems);
-        doData_init(data);
+        arena_free(data->elems);
+    }
+    if (data->index != NULL) {
+        arena_free(data->index);
+    }
+    doData_init(data);
+}
+
+#if DO_CODE_LENGTH >= 8
+#error "The DO index packs the codes in 64 bits"
+#endif
+
+// Pack a code that fits in a DO in an integer. Different codes give different keys
+static uint64_t doData_key(const char* code)
+{
+    uint64_t key;
+    
+    key = 0;
+    memcpy(&key, code, strnlen(code, DO_CODE_LENGTH));
+    
+    return key;
+}
+
+// Hash of the key of a DO code
+static unsigned int doData_hash(uint64_t key)
+{
+    // Fibonacci hashing, using the high bits of the product
+    return (unsigned int) ((key * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+// Store the position of a DO in the hash index
+static void doData_indexAdd(tDOData* data, int pos)
+{
+    unsigned int slot;
+    
+    slot = doData_hash(doData_key(data->elems[pos].code)) & (data->indexCapacity - 1);
+    while (data->index[slot] != DO_INDEX_EMPTY) {
+        slot = (slot + 1) & (data->indexCapacity - 1);
+    }
+    data->index[slot] = pos;
+}
+
+// Rebuild the hash index from the DOs stored in elems
+void doData_reindex(tDOData* data)
+{
+    int i;
+    
+    // Preconditions
+    assert(data != NULL);
+    
+    // Keep the load factor under 1/2
+    if (data->indexCapacity == 0) {
+        data->indexCapacity = 2 * DO_DATA_INITIAL_CAPACITY;
+    }
+    while (2 * (data->count + 1) > data->indexCapacity) {
+        data->indexCapacity *= 2;
+    }
+    
+    if (data->index != NULL) {
+        arena_free(data->index);
+    }
+    data->index = (int*)arena_malloc(data->indexCapacity * sizeof(int));
+    assert(data->index != NULL);
+    
+    for (i = 0; i < data->indexCapacity; i++) {
+        data->index[i] = DO_INDEX_EMPTY;
+    }
+    for (i = 0; i < data->count; i++) {
+        doData_indexAdd(data, i);
     }
 }
 
 // Return the number of DO in data
 int doData_len(tDOData data)
 {
-    return data.count;
+    return doData_len_ptr(&data);
 }
 
-// Insert a DO to the DO data
-tApiError doData_add(tDOData* data, tDO DO)
+// Return the number of DO in data, without copying the DO data
+int doData_len_ptr(const tDOData* data)
 {
     // Preconditions
     assert(data != NULL);
     
-    if (data->count == 0) {
-        data->elems = (tDO*)malloc(sizeof(tDO));
+    return data->count;
+}
+
+// Make room for a new DO at the end of the DO data
+static tApiError doData_reserve(tDOData* data)
+{
+    tDO* elems;
+    int capacity;
+    
+    // Double the capacity when it is full
+    if (data->count == data->capacity) {
+        capacity = (data->capacity == 0) ? DO_DATA_INITIAL_CAPACITY : data->capacity * 2;
+        elems = (tDO*)arena_realloc(data->elems, sizeof(tDO) * data->capacity, sizeof(tDO) * capacity);
+        if (elems == NULL) {
+            return E_MEMORY_ERROR;
+        }
+        data->elems = elems;
+        data->capacity = capacity;
+    }
+    
+    return E_SUCCESS;
+}
+
+// Count the DO stored at the end of the DO data and add it to the hash index
+static void doData_indexLast(tDOData* data)
+{
+    data->count++;
+    
+    // Add it to the hash index, making it larger if needed
+    if (2 * data->count > data->indexCapacity) {
+        doData_reindex(data);
     } else {
-        data->elems = (tDO*)realloc(data->elems, sizeof(tDO) * (data->count + 1));
+        doData_indexAdd(data, data->count - 1);
     }
+}
+
+// Insert a DO to the DO data
+tApiError doData_add(tDOData* data, tDO DO)
+{
+    tApiError error;
     
-    if (data->elems == NULL) {
-        return E_MEMORY_ERROR;
+    // Preconditions
+    assert(data != NULL);
+    
+    error = doData_reserve(data);
+    if (error != E_SUCCESS) {
+        return error;
     }
     
     do_cpy(&(data->elems[data->count]), DO);
-    data->count++;
+    doData_indexLast(data);
+    
+    return E_SUCCESS;
+}
+
+// Insert a DO to the DO data, taking its name and lists
+tApiError doData_addMove(tDOData* data, tDO* DO)
+{
+    tApiError error;
+    
+    // Preconditions
+    assert(data != NULL);
+    assert(DO != NULL);
+    assert(DO->code[0] != '\0');
+    
+    error = doData_reserve(data);
+    if (error != E_SUCCESS) {
+        return error;
+    }
+    
+    // The new position owns the data of the DO now
+    data->elems[data->count] = *DO;
+    do_initEmpty(DO);
+    doData_indexLast(data);
     
     return E_SUCCESS;
 }
@@ -134,18 +292,77 @@ tApiError doData_add(tDOData* data, tDO DO)
 // Find a DO in DO data
 tDO* doData_find(tDOData data, const char* code)
 {
-    int i;
+    return doData_find_ptr(&data, code);
+}
+
+// Find a DO in DO data, without copying the DO data
+tDO* doData_find_ptr(const tDOData* data, const char* code)
+{
+    int pos;
+    
+    // Preconditions
+    assert(data != NULL);
+    assert(code != NULL);
+    
+    if ((pos = doData_findPos_ptr(data, code)) == -1) {
+        return NULL;
+    }
+    
+    return &(data->elems[pos]);
+}
+
+// Return the position of a DO in DO data. -1 if it does not exist
+int doData_findPos(tDOData data, const char* code)
+{
+    return doData_findPos_ptr(&data, code);
+}
+
+// Return the position of a DO in DO data, without copying the DO data. -1 if it does not exist
+int doData_findPos_ptr(const tDOData* data, const char* code)
+{
+    unsigned int slot;
+    uint64_t key;
+    int pos;
     
     // Preconditions
+    assert(data != NULL);
     assert(code != NULL);
     
-    for (i = 0; i < data.count; i++) {
-        if (strcmp(data.elems[i].code, code) == 0) {
-            return &(data.elems[i]);
+    if (data->indexCapacity == 0) {
+        return -1;
+    }
+    
+    // A code that does not fit in a DO has no DO
+    if (!do_checkCode(code)) {
+        return -1;
+    }
+    
+    key = doData_key(code);
+    slot = doData_hash(key) & (data->indexCapacity - 1);
+    while ((pos = data->index[slot]) != DO_INDEX_EMPTY) {
+        if (doData_key(data->elems[pos].code) == key) {
+            return pos;
         }
+        slot = (slot + 1) & (data->indexCapacity - 1);
     }
     
-    return NULL;
+    return -1;
+}
+
+// Get the DO in a position returned by doData_findPos
+tDO* doData_get(tDOData data, int pos)
+{
+    return doData_get_ptr(&data, pos);
+}
+
+// Get the DO in a position returned by doData_findPos, without copying the DO data
+tDO* doData_get_ptr(const tDOData* data, int pos)
+{
+    // Preconditions
+    assert(data != NULL);
+    assert(pos >= 0 && pos < data->count);
+    
+    return &(data->elems[pos]);
 }
 
 // Parse input from CSVEntry
@@ -161,15 +378,12 @@ void do_parse(tDO* data, tCSVEntry entry) {
     // Release the DO
     do_free(data);
     
-    // Copy code data
-    data->code = (char*) malloc((strlen(entry.fields[pos]) + 1) * sizeof(char));
-    assert(data->code != NULL);
-    memset(data->code, 0, (strlen(entry.fields[pos]) + 1) * sizeof(char));
-    csv_getAsString(entry, pos, data->code, strlen(entry.fields[pos]) + 1);
+    // Copy the code, checked by the caller
+    do_setCode(data, entry.fields[pos]);
     
     // Copy name data
     pos = 1;
-    data->name = (char*) malloc((strlen(entry.fields[pos]) + 1) * sizeof(char));
+    data->name = (char*) arena_malloc((strlen(entry.fields[pos]) + 1) * sizeof(char));
     assert(data->name != NULL);
     memset(data->name, 0, (strlen(entry.fields[pos]) + 1) * sizeof(char));
     csv_getAsString(entry, pos, data->name, strlen(entry.fields[pos]) + 1);
@@ -184,24 +398,37 @@ void do_parse(tDO* data, tCSVEntry entry) {
 
 // Get the total weight from an specific winegrower
 double doData_getTotalWeightByWinegrower(tDO DO, const char* winegrowerId)
+{
+    return doData_getTotalWeightByWinegrower_ptr(&DO, winegrowerId);
+}
+
+// Get the total weight from an specific winegrower, without copying the DO
+double doData_getTotalWeightByWinegrower_ptr(const tDO* DO, const char* winegrowerId)
 {
     // PR2 EX 2a
     tWinegrower *winegrower;
     
     // Preconditions
+    assert(DO != NULL);
     assert(winegrowerId != NULL);
     
-    if ((winegrower = winegrowerList_find(DO.winegrowers, winegrowerId)) == NULL) {
+    if ((winegrower = winegrowerIndex_find(&(DO->winegrowerIndex), &(DO->winegrowers), winegrowerId)) == NULL) {
         return 0.0;
     }
     
-    return doData_getTotalWeightByWinegrower_recursive(winegrower->vineyardplots, winegrower->vineyardplots.count);
+    return doData_getTotalWeightByWinegrower_recursive_ptr(&(winegrower->vineyardplots), winegrower->vineyardplots.count);
     /////////////////////////////////
     //return 0.0;
 }
 
 // Recursive version to get the total weight
 double doData_getTotalWeightByWinegrower_recursive(tVineyardplotData vineyards, int index)
+{
+    return doData_getTotalWeightByWinegrower_recursive_ptr(&vineyards, index);
+}
+
+// Recursive version to get the total weight, without copying the vineyardplots data on each call
+double doData_getTotalWeightByWinegrower_recursive_ptr(const tVineyardplotData* vineyards, int index)
 {
     double totalWeight;
     
@@ -210,7 +437,7 @@ double doData_getTotalWeightByWinegrower_recursive(tVineyardplotData vineyards,
         totalWeight = 0.0;
     } else {
         // Recursive case
-        totalWeight = doData_getTotalWeightByWinegrower_recursive(vineyards, index-1) + vineyards.elems[index-1].weight;
+        totalWeight = doData_getTotalWeightByWinegrower_recursive_ptr(vineyards, index-1) + vineyards->elems[index-1].weight;
     }
     
     return totalWeight;
@@ -218,6 +445,12 @@ double doData_getTotalWeightByWinegrower_recursive(tVineyardplotData vineyards,
 
 // Get the total weighing for an specific winegrower, specific vineyard and specific year
 double doData_getTotalWeighingByWineGrowerAndVineyardByYear(tDO DO, const char* winegrowerId, const char* vineyardplotCode, int year)
+{
+    return doData_getTotalWeighingByWineGrowerAndVineyardByYear_ptr(&DO, winegrowerId, vineyardplotCode, year);
+}
+
+// Get the total weighing for an specific winegrower, specific vineyard and specific year, without copying the DO
+double doData_getTotalWeighingByWineGrowerAndVineyardByYear_ptr(const tDO* DO, const char* winegrowerId, const char* vineyardplotCode, int year)
 {
     // PR2 EX 2b
     tWinegrower *winegrower;
@@ -225,10 +458,11 @@ double doData_getTotalWeighingByWineGrowerAndVineyardByYear(tDO DO, const char*
     int idx;
     
     // Preconditions
+    assert(DO != NULL);
     assert(winegrowerId != NULL);
     assert(vineyardplotCode != NULL);
     
-    if ((winegrower = winegrowerList_find(DO.winegrowers, winegrowerId)) == NULL) {
+    if ((winegrower = winegrowerIndex_find(&(DO->winegrowerIndex), &(DO->winegrowers), winegrowerId)) == NULL) {
         return 0.0;
     }
     
@@ -264,8 +498,103 @@ double doData_getTotalWeighingByWineGrowerAndVineyardByYear_recursive(tWeighingN
     return totalWeighing;
 }
 
+// Add a copy of a winegrower to a DO
+tWinegrower* do_addWinegrower(tDO* DO, tWinegrower winegrower) {
+    tWinegrower* added;
+    
+    // Preconditions
+    assert(DO != NULL);
+    assert(winegrower.id != NULL);
+    
+    added = winegrowerIndex_find(&(DO->winegrowerIndex), &(DO->winegrowers), winegrower.id);
+    if (added == NULL) {
+        added = winegrowerIndex_insert(&(DO->winegrowerIndex), &(DO->winegrowers), winegrower);
+    }
+    
+    return added;
+}
+
+// Add a copy of a vineyardplot to a winegrower of a DO
+tApiError do_addVineyardplot(tDO* DO, const char* winegrowerId, tVineyardplot plot) {
+    tWinegrower* winegrower;
+    
+    // Preconditions
+    assert(DO != NULL);
+    assert(winegrowerId != NULL);
+    
+    winegrower = winegrowerIndex_find(&(DO->winegrowerIndex), &(DO->winegrowers), winegrowerId);
+    if (winegrower == NULL) {
+        return E_WINEGROWER_NOT_FOUND;
+    }
+    
+    // The copy has no weighings, so the store does not change
+    vineyardplotData_add(&(winegrower->vineyardplots), plot);
+    
+    return E_SUCCESS;
+}
+
+// Add a weighing to a vineyardplot of a winegrower of a DO
+tApiError do_addWeighing(tDO* DO, const char* winegrowerId, const char* vineyardplotCode, tWeighing weighing) {
+    tWinegrower* winegrower;
+    tVineyardplot* plot;
+    tApiError error;
+    int idx;
+    
+    // Preconditions
+    assert(DO != NULL);
+    assert(winegrowerId != NULL);
+    assert(vineyardplotCode != NULL);
+    
+    winegrower = winegrowerIndex_find(&(DO->winegrowerIndex), &(DO->winegrowers), winegrowerId);
+    if (winegrower == NULL) {
+        return E_WINEGROWER_NOT_FOUND;
+    }
+    
+    idx = vineyardplotData_find(winegrower->vineyardplots, vineyardplotCode);
+    if (idx < 0) {
+        return E_VINEYARD_NOT_FOUND;
+    }
+    plot = &(winegrower->vineyardplots.elems[idx]);
+    
+    error = weighingList_add(&(plot->weights), weighing);
+    if (error != E_SUCCESS) {
+        return error;
+    }
+    
+    // A merged weighing is one more row of the store, so the sums are the same
+    if (DO->weighings.valid) {
+        weighingStore_add(&(DO->weighings), winegrower, plot, weighing);
+    }
+    
+    // Added or merged, the weight goes to the total of its year
+    weighingTotals_add(&(DO->totals), weighing.harvestDay.year, weighing.weight);
+    
+    return E_SUCCESS;
+}
+
+// Store the weighings of all the winegrowers of a DO by columns
+void do_buildWeighings(tDO* DO) {
+    // Preconditions
+    assert(DO != NULL);
+
+    weighingStore_build(&(DO->weighings), DO->winegrowers);
+}
+
+// Compute the totals by year of the weighings of all the winegrowers of a DO
+void do_buildTotals(tDO* DO) {
+    // Preconditions
+    assert(DO != NULL);
+
+    weighingTotals_build(&(DO->totals), DO->winegrowers);
+}
+
 // Get the total weighing for a specific DO on a specific year
 double do_getTotalWeighing(tDO DO, int year) {
+    return do_getTotalWeighing_ptr(&DO, year);
+}
+
+// Get the total weighing for a specific DO on a specific year, without copying the DO
+double do_getTotalWeighing_ptr(const tDO* DO, int year) {
     // PR3 EX 3a
     // Each DO can have multiple vineyards and each vineyard can have multiple weighings for a given year
     // The sum of all the weighing for a given year is returned by this method
@@ -274,8 +603,24 @@ double do_getTotalWeighing(tDO DO, int year) {
     tVineyardplot* vineyardplot;
     tWeighingNode* weighingNode;
     
+    // Preconditions
+    assert(DO != NULL);
+    
+    //If the DO keeps its totals by year, the one of the year is read without walking the lists
+    if (weighingTotals_find(&(DO->totals), year, &totalWeight)) {
+        return totalWeight;
+    }
+    
+    //If the weighings are stored by columns, add the ones of the year without walking the lists
+    if (DO->weighings.valid) {
+        return weighingStore_sumByYear(&(DO->weighings), year);
+    }
+    
+    //Without totals or a store, the lists are walked
+    totalWeight = 0.0;
+    
     //Assign the first node of the wg first node from the source list to a winegrower new Node
-   tWinegrowerNode* winegrowerNode = DO.winegrowers.first;
+   tWinegrowerNode* winegrowerNode = DO->winegrowers.first;
     
     //While this winegrower new Node is null (or in the first iteration the struct is not empty)
     while (winegrowerNode != NULL) {
@@ -306,6 +651,45 @@ double do_getTotalWeighing(tDO DO, int year) {
     return totalWeight;
 }
 
+// Find the winegrowers of a DO that have a vineyardplot of a grape variety with weighings in a year
+tWinegrowerList do_findWinegrowersByWeighingYearAndGrapevariety(const tDO* DO, int year, tGrapeVariety grapeVariety) {
+    tWinegrowerList list;
+    tWinegrowerIndex index;
+    tWinegrower* winegrower;
+    bool* plots;
+    int i;
+    
+    // Preconditions
+    assert(DO != NULL);
+    
+    if (!DO->weighings.valid) {
+        return winegrowerList_findByWeighingYearAndGrapevariety(DO->winegrowers, year, grapeVariety);
+    }
+    
+    winegrowerList_init(&list);
+    if (DO->weighings.plotCount == 0) {
+        return list;
+    }
+    plots = (bool*) calloc(DO->weighings.plotCount, sizeof(bool));
+    assert(plots != NULL);
+    
+    // Mark the vineyardplots with weighings of the year in a single pass over the store, and link their
+    // winegrowers in id order through an index of the new list
+    if (weighingStore_countByYear(&(DO->weighings), year, grapeVariety, plots) > 0) {
+        winegrowerIndex_init(&index);
+        for (i = 0; i < DO->weighings.plotCount; i++) {
+            winegrower = DO->weighings.plotList[i].winegrower;
+            if (plots[i] && winegrowerIndex_find(&index, &list, winegrower->id) == NULL) {
+                winegrowerIndex_insert(&index, &list, *winegrower);
+            }
+        }
+        winegrowerIndex_free(&index);
+    }
+    free(plots);
+    
+    return list;
+}
+
 // Sort a DO Data by the weighing on a given year
 tDOData doData_orderByWeighing(tDOData* DOData, int year) {
     // PR3 EX 3b
@@ -315,6 +699,7 @@ tDOData doData_orderByWeighing(tDOData* DOData, int year) {
     
     tDOData newDOData;
     tApiError error;
+    bool* built;
     
     // Initialize a newDOData structure
     doData_init(&newDOData);
@@ -322,7 +707,7 @@ tDOData doData_orderByWeighing(tDOData* DOData, int year) {
     //If the input data is not empty
     if (DOData->count > 0) {
         //Allocate memory to the newDODAta as the input DODAta
-        newDOData.elems = (tDO*)malloc(DOData->count * sizeof(tDO));
+        newDOData.elems = (tDO*)arena_malloc(DOData->count * sizeof(tDO));
         
         //Assign to the new DOData the same count as input
         newDOData.count = DOData->count;
@@ -339,8 +724,28 @@ tDOData doData_orderByWeighing(tDOData* DOData, int year) {
                 return newDOData;
             }
         }
+        //The sort gets the total weighing of each DO many times, so the DOs without totals get them meanwhile
+        built = (bool*) calloc(DOData->count, sizeof(bool));
+        assert(built != NULL);
+        for (int i = 0; i < DOData->count; i++) {
+            if (!DOData->elems[i].totals.valid) {
+                do_buildTotals(&(DOData->elems[i]));
+                built[i] = true;
+            }
+        }
         // When the DOData has been copied to the newDODAta, we sort this new structure with quickSort method
         quickSort(newDOData.elems, 0, newDOData.count - 1, year, DOData);
+        //Only the totals built for the sort are released, as the winegrowers can be modified by other means after it
+        for (int i = 0; i < DOData->count; i++) {
+            if (built[i]) {
+                weighingTotals_free(&(DOData->elems[i].totals));
+            }
+        }
+        free(built);
+        
+        //The positions changed with the sort, so the hash index of the new structure is built now
+        newDOData.capacity = newDOData.count;
+        doData_reindex(&newDOData);
     }
     //Return the new structure
     return newDOData;
@@ -369,34 +774,34 @@ void quickSort(tDO* v, int begin, int end, int year, tDOData* DOData) {
         //While data in i position is smaller or iqual than the j one
         while (i <= j) {
             //Assign to an iAux, jAux and pivotAux pointer de DODAta searched from the input
-            tDO* iAux = doData_find(*DOData, v[i].code);
-            tDO* jAux = doData_find(*DOData, v[j].code);
-            tDO* pivotAux = doData_find(*DOData, pivot.code);
+            tDO* iAux = doData_find_ptr(DOData, v[i].code);
+            tDO* jAux = doData_find_ptr(DOData, v[j].code);
+            tDO* pivotAux = doData_find_ptr(DOData, pivot.code);
             //While the i value is smaller or equal to the end input value and the aux pointers are not null AND 
             //(the weihing of the iAux pointer and input year is greater than the pivot one )OR
             //(the weihing of the iAux pointer and input year is equal to the pivot one and the code of i pointer is smaller than the pivot one)
             while (i <= end && iAux != NULL && pivotAux != NULL && 
-                    (do_getTotalWeighing(*iAux, year) > do_getTotalWeighing(*pivotAux, year) || 
-                    (do_getTotalWeighing(*iAux, year) == do_getTotalWeighing(*pivotAux, year) && strcmp(v[i].code, pivot.code) <= 0))) {
+                    (do_getTotalWeighing_ptr(iAux, year) > do_getTotalWeighing_ptr(pivotAux, year) || 
+                    (do_getTotalWeighing_ptr(iAux, year) == do_getTotalWeighing_ptr(pivotAux, year) && strcmp(v[i].code, pivot.code) <= 0))) {
                 //Iterate to the next position of i since the weight is greater than the one in the pivot position so we don't need to exchange
                 i++;
                 if (i <= end) {
                     //ASsign to iAux pointer the value of the new i position after the iteration
-                    iAux = doData_find(*DOData, v[i].code);
+                    iAux = doData_find_ptr(DOData, v[i].code);
                 }
             }
             //While jAux pointer is not null nor the pivotAux one AND
             //(the year of the jAux pointer is lower than the pivot one) OR
             //(the year of the jAux pointer is equal to the pivot one and the j code is greater than the pivot one)
             while (jAux != NULL && pivotAux != NULL &&
-                    (do_getTotalWeighing(*jAux, year) < do_getTotalWeighing(*pivotAux, year) || 
-                    (do_getTotalWeighing(*jAux, year) == do_getTotalWeighing(*pivotAux, year) && strcmp(v[j].code, pivot.code) > 0))) {
+                    (do_getTotalWeighing_ptr(jAux, year) < do_getTotalWeighing_ptr(pivotAux, year) || 
+                    (do_getTotalWeighing_ptr(jAux, year) == do_getTotalWeighing_ptr(pivotAux, year) && strcmp(v[j].code, pivot.code) > 0))) {
                 //DEcrease j in one position
                 j--;
                 //If j still greater or equal than the begin position
                 if (j >= begin) {
                     //Assign to jAux pointer the value of the new j position after decreasing the j value
-                    jAux = doData_find(*DOData, v[j].code); 
+                    jAux = doData_find_ptr(DOData, v[j].code); 
                 }
             }
             //If i value is smaller than j value
@@ -2,30 +2,51 @@
 #define __DO_H__
 
 #include "winegrower.h"
+#include "winegrowerindex.h"
+#include "weighingstore.h"
+#include "weighingtotals.h"
 
 #define NUM_FIELDS_DO 3
 
 // Maximum length of DO name
 #define MAX_DO_NAME_LENGTH 64
 
+// The code is kept inside the DO, padded with '\0', so the DO index compares it as an integer
 typedef struct _tDO { 
-    char *code;
+    char code[DO_CODE_LENGTH + 1];
     char *name;
     tWinegrowerList winegrowers;
+    tWinegrowerIndex winegrowerIndex;
     double avgCropField;
     tVineyardplotData vineyards;
+    tWeighingStore weighings;
+    tWeighingTotals totals;
 } tDO;
 
+// Initial number of positions allocated for DOs and for the hash index
+#define DO_DATA_INITIAL_CAPACITY 8
+
+// Value of the free positions of the hash index
+#define DO_INDEX_EMPTY -1
+
+// DOs are stored in insertion order, with an open addressing hash table from code to position.
+// Positions are stable handles: they stay valid when the data grows, while pointers may not
 typedef struct _tDOData {
     tDO *elems;
     int count;
+    int capacity;
+    int *index;
+    int indexCapacity;
 } tDOData;
 
 
 // Initialize to NULL all pointers of a DO
 void do_initEmpty(tDO* DO);
 
-// Initialize a DO
+// Check if a code fits in a DO
+bool do_checkCode(const char* code);
+
+// Initialize a DO. Return E_INVALID_ENTRY_FORMAT if the code does not fit
 tApiError do_init(tDO* DO, const char* code, const char* name, double avgCropField);
 
 // Copy a DO
@@ -43,30 +64,94 @@ void doData_free(tDOData* data);
 // Return the number of DO in data
 int doData_len(tDOData data);
 
+// Return the number of DO in data, without copying the DO data
+int doData_len_ptr(const tDOData* data);
+
 // Insert a DO to the DO data
 tApiError doData_add(tDOData* data, tDO DO);
 
+// Insert a DO to the DO data, taking its name and lists instead of copying them. The DO is left empty
+tApiError doData_addMove(tDOData* data, tDO* DO);
+
 // Find a DO in DO data
 tDO* doData_find(tDOData data, const char* code);
 
+// Find a DO in DO data, without copying the DO data
+tDO* doData_find_ptr(const tDOData* data, const char* code);
+
+// Return the position of a DO in DO data. -1 if it does not exist
+int doData_findPos(tDOData data, const char* code);
+
+// Return the position of a DO in DO data, without copying the DO data. -1 if it does not exist
+int doData_findPos_ptr(const tDOData* data, const char* code);
+
+// Get the DO in a position returned by doData_findPos
+tDO* doData_get(tDOData data, int pos);
+
+// Get the DO in a position returned by doData_findPos, without copying the DO data
+tDO* doData_get_ptr(const tDOData* data, int pos);
+
+// Rebuild the hash index from the DOs stored in elems
+void doData_reindex(tDOData* data);
+
 // Parse input from CSVEntry
 void do_parse(tDO* data, tCSVEntry entry);
 
 // Get the total weight from an specific winegrower
 double doData_getTotalWeightByWinegrower(tDO DO, const char* winegrowerId);
 
+// Get the total weight from an specific winegrower, without copying the DO
+double doData_getTotalWeightByWinegrower_ptr(const tDO* DO, const char* winegrowerId);
+
 // Recursive version to get the total weight
 double doData_getTotalWeightByWinegrower_recursive(tVineyardplotData vineyards, int index);
 
+// Recursive version to get the total weight, without copying the vineyardplots data on each call
+double doData_getTotalWeightByWinegrower_recursive_ptr(const tVineyardplotData* vineyards, int index);
+
 // Get the total weighing for an specific winegrower, specific vineyard and specific year
 double doData_getTotalWeighingByWineGrowerAndVineyardByYear(tDO DO, const char* winegrowerId, const char* vineyardplotCode, int year);
 
+// Get the total weighing for an specific winegrower, specific vineyard and specific year, without copying the DO
+double doData_getTotalWeighingByWineGrowerAndVineyardByYear_ptr(const tDO* DO, const char* winegrowerId, const char* vineyardplotCode, int year);
+
 // Recursive version to get the total weighing
 double doData_getTotalWeighingByWineGrowerAndVineyardByYear_recursive(tWeighingNode *pNode, int year);
 
+// Add a copy of a winegrower to a DO. As with winegrower_cpy, the copy has no vineyardplots. If the DO has
+// a winegrower with the same id, nothing is added. Return the winegrower of the DO with that id
+tWinegrower* do_addWinegrower(tDO* DO, tWinegrower winegrower);
+
+// Add a copy of a vineyardplot, without weighings, to a winegrower of a DO if it does not have it yet
+tApiError do_addVineyardplot(tDO* DO, const char* winegrowerId, tVineyardplot plot);
+
+// Add a weighing to a vineyardplot of a winegrower of a DO, merged with the weighing of the same day and code
+// if there is one
+tApiError do_addWeighing(tDO* DO, const char* winegrowerId, const char* vineyardplotCode, tWeighing weighing);
+
+// Store the weighings of all the winegrowers of a DO by columns. From then on do_addWeighing adds to the store
+// too, and do_getTotalWeighing and do_findWinegrowersByWeighingYearAndGrapevariety
+// aggregate it instead of walking the lists. It must be built again after the lists are changed by other means
+void do_buildWeighings(tDO* DO);
+
+// Compute the totals by year of the weighings of all the winegrowers of a DO, that do_getTotalWeighing reads
+// in constant time. From then on do_addWeighing adds to them too, and do_free releases them. They must be built
+// again after the lists are changed by other means
+void do_buildTotals(tDO* DO);
+
 // Get the total weighing for a specific DO on a specific year
 double do_getTotalWeighing(tDO DO, int year);
 
+// Get the total weighing for a specific DO on a specific year, without copying the DO.
+// It reads the totals or the store of the DO if they are valid, and walks the lists otherwise. It does not
+// write the DO, so it can be called from several threads
+double do_getTotalWeighing_ptr(const tDO* DO, int year);
+
+// Find the winegrowers of a DO that have a vineyardplot of a grape variety with weighings in a year, as
+// winegrowerList_findByWeighingYearAndGrapevariety does with the winegrowers of the DO. It counts the weighings
+// of the store of the DO if it is valid
+tWinegrowerList do_findWinegrowersByWeighingYearAndGrapevariety(const tDO* DO, int year, tGrapeVariety grapeVariety);
+
 // Sort a DO data by the weighing in a given year
 tDOData doData_orderByWeighing(tDOData* DOData, int year);
 
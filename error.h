@@ -18,6 +18,9 @@ enum _tApiError
     E_WINEGROWER_NOT_FOUND = -11, // winegrower not found
     E_DUPLICATED_DO = -12, // Duplicated DO
     E_DUPLICATED_WEIGHING = -13, // Duplicated Weighing
+    E_INVALID_SNAPSHOT = -14, // Invalid or incompatible snapshot file
+    E_FILE_READ_ERROR = -15, // The file could not be read to the end
+    E_FILE_WRITE_ERROR = -16, // The file could not be written completely
 };
 
 // Define an error type
@@ -0,0 +1,86 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "nodepool.h"
+#include "arena.h"
+
+// Pools of the nodes of the lists
+static tNodePool nodePool_weighings = NODE_POOL_INITIALIZER(sizeof(tWeighingNodeHeader), sizeof(tWeighingNode));
+static tNodePool nodePool_winegrowers = NODE_POOL_INITIALIZER(0, sizeof(tWinegrowerNode));
+
+// Get a node from the pool
+void* nodePool_alloc(tNodePool* pool) {
+    void* node;
+    char* slab;
+
+    assert(pool != NULL);
+
+    // Nodes stored in the application data go to its arena, that is already contiguous
+    if (arena_current() != NULL) {
+        node = arena_malloc(pool->nodeSize);
+        return node != NULL ? (char*) node + pool->headerSize : NULL;
+    }
+
+    pthread_mutex_lock(&(pool->lock));
+    if (pool->freeList != NULL) {
+        // Use the last released node
+        node = pool->freeList;
+        pool->freeList = *((void**) node);
+    } else {
+        if (pool->slabUsed + pool->nodeSize > NODE_POOL_SLAB_SIZE) {
+            // Take a new slab, linked to the previous one through its first word
+            slab = (char*) malloc(NODE_POOL_SLAB_SIZE);
+            assert(slab != NULL);
+            *((char**) slab) = pool->slab;
+            pool->slab = slab;
+            pool->slabUsed = sizeof(char*);
+        }
+        node = pool->slab + pool->slabUsed;
+        pool->slabUsed += pool->nodeSize;
+    }
+    pthread_mutex_unlock(&(pool->lock));
+
+    return (char*) node + pool->headerSize;
+}
+
+// Return a node to the pool
+void nodePool_free(tNodePool* pool, void* node) {
+    assert(pool != NULL);
+
+    if (node == NULL || arena_contains(node)) {
+        return;
+    }
+    node = (char*) node - pool->headerSize;
+
+    pthread_mutex_lock(&(pool->lock));
+    *((void**) node) = pool->freeList;
+    pool->freeList = node;
+    pthread_mutex_unlock(&(pool->lock));
+}
+
+// Get a node for a weighing list
+tWeighingNode* nodePool_newWeighingNode() {
+    tWeighingNode* node;
+
+    node = (tWeighingNode*) nodePool_alloc(&nodePool_weighings);
+    if (node != NULL) {
+        NODE_POOL_WEIGHING_HEADER(node)->index = NULL;
+        NODE_POOL_WEIGHING_HEADER(node)->day = 0;
+    }
+
+    return node;
+}
+
+// Release a node of a weighing list
+void nodePool_freeWeighingNode(tWeighingNode* node) {
+    nodePool_free(&nodePool_weighings, node);
+}
+
+// Get a node for a winegrower list
+tWinegrowerNode* nodePool_newWinegrowerNode() {
+    return (tWinegrowerNode*) nodePool_alloc(&nodePool_winegrowers);
+}
+
+// Release a node of a winegrower list
+void nodePool_freeWinegrowerNode(tWinegrowerNode* node) {
+    nodePool_free(&nodePool_winegrowers, node);
+}
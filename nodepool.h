@@ -0,0 +1,56 @@
+#ifndef __NODEPOOL_H__
+#define __NODEPOOL_H__
+
+#include <stddef.h>
+#include <pthread.h>
+#include "winegrower.h"
+
+// Size of the slabs of contiguous nodes taken from the heap by a pool
+#define NODE_POOL_SLAB_SIZE (64 * 1024)
+
+// Data kept just before each node of a weighing list: the packed harvest day of its weighing, set when the node
+// is created or on first use (0 until then), and in the first node of the list, the ordered index of the list
+typedef struct _tWeighingNodeHeader {
+    struct _tWeighingIndex* index;
+    tPackedDate day;
+} tWeighingNodeHeader;
+
+// Get the header of a node of a weighing list taken from the pool
+#define NODE_POOL_WEIGHING_HEADER(node) (((tWeighingNodeHeader*) (node)) - 1)
+
+// Pool of nodes of a fixed size. Nodes are carved in order from slabs and released nodes are kept in a free
+// list to be used again. Slabs are linked through their first word and are never returned to the heap.
+// Each node can have a header of headerSize bytes in front of it, that is allocated and released with it
+typedef struct _tNodePool {
+    size_t headerSize;
+    size_t nodeSize;
+    void* freeList;
+    char* slab;
+    size_t slabUsed;
+    pthread_mutex_t lock;
+} tNodePool;
+
+// Initial value of a pool of nodes of the given size, each one after a header of the given size. The header
+// size must be a multiple of 8
+#define NODE_POOL_INITIALIZER(header, size) { (header), ((header) + (size) + 7) & ~((size_t) 7), NULL, NULL, \
+    NODE_POOL_SLAB_SIZE, PTHREAD_MUTEX_INITIALIZER }
+
+// Get a node from the pool. If there is an active arena, the node is taken from the arena instead
+void* nodePool_alloc(tNodePool* pool);
+
+// Return a node to the pool. Nodes of an arena are released with the arena
+void nodePool_free(tNodePool* pool, void* node);
+
+// Get a node for a weighing list, with its header cleared
+tWeighingNode* nodePool_newWeighingNode();
+
+// Release a node of a weighing list
+void nodePool_freeWeighingNode(tWeighingNode* node);
+
+// Get a node for a winegrower list
+tWinegrowerNode* nodePool_newWinegrowerNode();
+
+// Release a node of a winegrower list
+void nodePool_freeWinegrowerNode(tWinegrowerNode* node);
+
+#endif
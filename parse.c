@@ -0,0 +1,196 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include "parse.h"
+
+// Maximum number of significant digits accumulated exactly in an integer
+#define PARSE_MAX_DIGITS 19
+
+// Exact powers of ten representable as a double
+static const double parse_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Check if a character is a decimal digit, independently of the locale
+static inline bool parse_isDigit(char c) {
+    return (unsigned char)(c - '0') <= 9;
+}
+
+// Value of two digits starting at text
+static inline int parse_twoDigits(const char* text) {
+    return (text[0] - '0') * 10 + (text[1] - '0');
+}
+
+// Parse a date with the fixed format dd/mm/yyyy
+bool parse_date(const char* text, int len, int* day, int* month, int* year) {
+    assert(text != NULL);
+    assert(day != NULL);
+    assert(month != NULL);
+    assert(year != NULL);
+
+    if (len != 10 || text[2] != '/' || text[5] != '/') {
+        return false;
+    }
+    if (!parse_isDigit(text[0]) || !parse_isDigit(text[1]) || !parse_isDigit(text[3]) || !parse_isDigit(text[4])
+            || !parse_isDigit(text[6]) || !parse_isDigit(text[7]) || !parse_isDigit(text[8]) || !parse_isDigit(text[9])) {
+        return false;
+    }
+
+    *day = parse_twoDigits(text);
+    *month = parse_twoDigits(text + 3);
+    *year = parse_twoDigits(text + 6) * 100 + parse_twoDigits(text + 8);
+
+    return true;
+}
+
+// Parse a time with the fixed format hh:mm
+bool parse_time(const char* text, int len, int* hour, int* minutes) {
+    assert(text != NULL);
+    assert(hour != NULL);
+    assert(minutes != NULL);
+
+    if (len != 5 || text[2] != ':') {
+        return false;
+    }
+    if (!parse_isDigit(text[0]) || !parse_isDigit(text[1]) || !parse_isDigit(text[3]) || !parse_isDigit(text[4])) {
+        return false;
+    }
+
+    *hour = parse_twoDigits(text);
+    *minutes = parse_twoDigits(text + 3);
+
+    return true;
+}
+
+// Skip the leading blanks and the sign. Return the position of the first digit
+static int parse_sign(const char* text, int len, bool* negative) {
+    int i = 0;
+
+    while (i < len && (text[i] == ' ' || text[i] == '\t')) {
+        i++;
+    }
+    *negative = false;
+    if (i < len && (text[i] == '-' || text[i] == '+')) {
+        *negative = (text[i] == '-');
+        i++;
+    }
+
+    return i;
+}
+
+// Parse an integer number [+-]digits
+bool parse_integer(const char* text, int len, int* value) {
+    bool negative;
+    int64_t result;
+    int i, start;
+
+    assert(text != NULL);
+    assert(value != NULL);
+
+    i = parse_sign(text, len, &negative);
+    start = i;
+    result = 0;
+    while (i < len && parse_isDigit(text[i])) {
+        // Saturate instead of overflowing
+        if (result <= INT32_MAX) {
+            result = result * 10 + (text[i] - '0');
+        }
+        i++;
+    }
+    if (result > INT32_MAX) {
+        result = negative ? (int64_t) INT32_MAX + 1 : INT32_MAX;
+    }
+
+    *value = (int) (negative ? -result : result);
+
+    return i > start && i == len;
+}
+
+// Parse a decimal number [+-]digits[.digits][e[+-]digits]
+bool parse_double(const char* text, int len, double* value) {
+    bool negative, negativeExponent;
+    uint64_t mantissa;
+    int i, j, digits, numDigits, scale, exponent;
+    double result;
+
+    assert(text != NULL);
+    assert(value != NULL);
+
+    i = parse_sign(text, len, &negative);
+    mantissa = 0;
+    digits = 0;
+    numDigits = 0;
+    scale = 0;
+
+    // Integer part. Digits that do not fit in the mantissa only scale the value
+    while (i < len && parse_isDigit(text[i])) {
+        if (digits < PARSE_MAX_DIGITS) {
+            mantissa = mantissa * 10 + (text[i] - '0');
+            if (mantissa > 0) {
+                digits++;
+            }
+        } else {
+            scale++;
+        }
+        numDigits++;
+        i++;
+    }
+
+    // Fractional part
+    if (i < len && text[i] == '.') {
+        i++;
+        while (i < len && parse_isDigit(text[i])) {
+            if (digits < PARSE_MAX_DIGITS) {
+                mantissa = mantissa * 10 + (text[i] - '0');
+                if (mantissa > 0) {
+                    digits++;
+                }
+                scale--;
+            }
+            numDigits++;
+            i++;
+        }
+    }
+
+    // Exponent, only when it has digits
+    if (numDigits > 0 && i + 1 < len && (text[i] == 'e' || text[i] == 'E')) {
+        j = i + 1;
+        negativeExponent = false;
+        if (text[j] == '-' || text[j] == '+') {
+            negativeExponent = (text[j] == '-');
+            j++;
+        }
+        if (j < len && parse_isDigit(text[j])) {
+            exponent = 0;
+            while (j < len && parse_isDigit(text[j])) {
+                if (exponent < 10000) {
+                    exponent = exponent * 10 + (text[j] - '0');
+                }
+                j++;
+            }
+            scale += negativeExponent ? -exponent : exponent;
+            i = j;
+        }
+    }
+
+    // A mantissa below 2^53 and a power of ten up to 1e22 are exact, so the result is correctly rounded
+    result = (double) mantissa;
+    if (scale < 0) {
+        while (scale < -22) {
+            result /= 1e22;
+            scale += 22;
+        }
+        result /= parse_pow10[-scale];
+    } else if (scale > 0) {
+        while (scale > 22) {
+            result *= 1e22;
+            scale -= 22;
+        }
+        result *= parse_pow10[scale];
+    }
+
+    *value = negative ? -result : result;
+
+    return numDigits > 0 && i == len;
+}
@@ -0,0 +1,23 @@
+#ifndef __PARSE_H__
+#define __PARSE_H__
+
+#include <stdbool.h>
+
+// Locale independent parsers for the fields of the CSV files. All of them work on the first len
+// characters of the text and return false if the text does not match the expected format
+
+// Parse a date with the fixed format dd/mm/yyyy
+bool parse_date(const char* text, int len, int* day, int* month, int* year);
+
+// Parse a time with the fixed format hh:mm
+bool parse_time(const char* text, int len, int* hour, int* minutes);
+
+// Parse an integer number [+-]digits. As atoi, leading blanks are skipped and the value of the
+// longest valid prefix is stored even if the text contains other characters
+bool parse_integer(const char* text, int len, int* value);
+
+// Parse a decimal number [+-]digits[.digits][e[+-]digits] as "20.00". As atof, leading blanks are skipped and
+// the value of the longest valid prefix is stored even if the text contains other characters
+bool parse_double(const char* text, int len, double* value);
+
+#endif
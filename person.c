@@ -3,7 +3,10 @@
 #include <string.h>
 #include <stdio.h>
 #include "person.h"
+#include "arena.h"
 
+// Number of texts of a person
+#define PERSON_NUM_TEXTS 7
 
 // Initialize the people data
 void people_init(tPeople* data) {
@@ -12,6 +15,10 @@ void people_init(tPeople* data) {
     
     data->elems = NULL;
     data->count = 0;
+    data->capacity = 0;
+    data->removed = 0;
+    data->index = NULL;
+    data->indexCapacity = 0;
 }
 
 // Initialize a person structure
@@ -36,35 +43,44 @@ void person_free(tPerson* data) {
     // Check input data
     assert(data != NULL);
     
-    // Release document data
-    if(data->document != NULL) free(data->document);
+    // All the texts are in the block that starts at the document
+    if(data->document != NULL) arena_free(data->document);
     data->document = NULL;
-    
-    // Release name data
-    if(data->name != NULL) free(data->name);
     data->name = NULL;
-    
-    // Release surname data
-    if(data->surname != NULL) free(data->surname);
     data->surname = NULL;
-    
-    // Release phone data
-    if(data->phone != NULL) free(data->phone);
     data->phone = NULL;
-    
-    // Release email data
-    if(data->email != NULL) free(data->email);
     data->email = NULL;
-    
-    // Release address data
-    if(data->address != NULL) free(data->address);
     data->address = NULL;
-    
-    // Release cp data
-    if(data->cp != NULL) free(data->cp);
     data->cp = NULL;
 }
 
+// Store the texts of a person in a single block
+static void person_setTexts(tPerson* data, const char* texts[PERSON_NUM_TEXTS]) {
+    char** fields[PERSON_NUM_TEXTS] = { &(data->document), &(data->name), &(data->surname), &(data->phone),
+        &(data->email), &(data->address), &(data->cp) };
+    size_t lengths[PERSON_NUM_TEXTS];
+    size_t size;
+    char* block;
+    int i;
+    
+    // Measure all the texts, to allocate them at once
+    size = 0;
+    for (i = 0; i < PERSON_NUM_TEXTS; i++) {
+        lengths[i] = strlen(texts[i]);
+        size += lengths[i] + 1;
+    }
+    block = (char*) arena_malloc(size * sizeof(char));
+    assert(block != NULL);
+    
+    // Copy each text after the previous one
+    for (i = 0; i < PERSON_NUM_TEXTS; i++) {
+        *(fields[i]) = block;
+        memcpy(block, texts[i], lengths[i]);
+        block[lengths[i]] = '\0';
+        block += lengths[i] + 1;
+    }
+}
+
 // Remove the data from all persons
 void people_free(tPeople* data) {
     int i;
@@ -78,16 +94,112 @@ void people_free(tPeople* data) {
     }    
     
     // Release memory
-    if (data->count > 0) {
-        free(data->elems);
-        data->elems = NULL;
-        data->count = 0;
+    if (data->elems != NULL) {
+        arena_free(data->elems);
+    }
+    if (data->index != NULL) {
+        arena_free(data->index);
+    }
+    people_init(data);
+}
+
+// Hash of a document (FNV-1a)
+static unsigned int people_hash(const char* document) {
+    unsigned int hash = 2166136261u;
+    
+    while (*document != '\0') {
+        hash ^= (unsigned char) *document;
+        hash *= 16777619u;
+        document++;
+    }
+    
+    return hash;
+}
+
+// Store the position of a person in the hash index
+static void people_indexAdd(tPeople* data, int pos) {
+    unsigned int slot;
+    
+    slot = people_hash(data->elems[pos].document) & (data->indexCapacity - 1);
+    while (data->index[slot] != PEOPLE_INDEX_EMPTY) {
+        slot = (slot + 1) & (data->indexCapacity - 1);
+    }
+    data->index[slot] = pos;
+}
+
+// Return the slot of the hash index that holds the person with provided document. -1 if it does not exist
+static int people_indexFind(const tPeople* data, const char* document) {
+    unsigned int slot;
+    int pos;
+    
+    if (data->indexCapacity == 0) {
+        return -1;
     }
+    
+    slot = people_hash(document) & (data->indexCapacity - 1);
+    while ((pos = data->index[slot]) != PEOPLE_INDEX_EMPTY) {
+        if (pos != PEOPLE_INDEX_REMOVED && strcmp(data->elems[pos].document, document) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & (data->indexCapacity - 1);
+    }
+    
+    return -1;
+}
+
+// Rebuild the hash index from the people stored in elems
+void people_reindex(tPeople* data) {
+    int i;
+    
+    // Check input data
+    assert(data != NULL);
+    
+    // Keep the load factor under 1/2, counting the positions of removed people
+    if (data->indexCapacity == 0) {
+        data->indexCapacity = PEOPLE_INITIAL_CAPACITY;
+    }
+    while (2 * (data->count + 1) > data->indexCapacity) {
+        data->indexCapacity *= 2;
+    }
+    
+    if (data->index != NULL) {
+        arena_free(data->index);
+    }
+    data->index = (int*) arena_malloc(data->indexCapacity * sizeof(int));
+    assert(data->index != NULL);
+    
+    for (i = 0; i < data->indexCapacity; i++) {
+        data->index[i] = PEOPLE_INDEX_EMPTY;
+    }
+    for (i = 0; i < data->count; i++) {
+        if (data->elems[i].document != NULL) {
+            people_indexAdd(data, i);
+        }
+    }
+}
+
+// Move the remaining people to the beginning of elems, keeping their order
+static void people_compact(tPeople* data) {
+    int i, j;
+    
+    j = 0;
+    for (i = 0; i < data->count; i++) {
+        if (data->elems[i].document != NULL) {
+            data->elems[j] = data->elems[i];
+            j++;
+        }
+    }
+    data->count = j;
+    data->removed = 0;
+    
+    people_reindex(data);
 }
 
 
 // Parse input from CSVEntry
 void person_parse(tPerson* data, tCSVEntry entry) {
+    const char* texts[PERSON_NUM_TEXTS];
+    
     // Check input data
     assert(data != NULL);
     
@@ -99,59 +211,17 @@ void person_parse(tPerson* data, tCSVEntry entry) {
     // Remove old data
     person_free(data);
       
-    // Copy identity document data
-    data->document = (char*) malloc((strlen(entry.fields[pos]) + 1) * sizeof(char));
-    assert(data->document != NULL);
-    memset(data->document, 0, (strlen(entry.fields[pos]) + 1) * sizeof(char));
-    csv_getAsString(entry, pos, data->document, strlen(entry.fields[pos]) + 1);
-    
-    // Copy name data
-    pos = 1;
-    data->name = (char*) malloc((strlen(entry.fields[pos]) + 1) * sizeof(char));
-    assert(data->name != NULL);
-    memset(data->name, 0, (strlen(entry.fields[pos]) + 1) * sizeof(char));
-    csv_getAsString(entry, pos, data->name, strlen(entry.fields[pos]) + 1);
-    
-    // Copy surname data
-    pos = 2;
-    data->surname = (char*) malloc((strlen(entry.fields[pos]) + 1) * sizeof(char));
-    assert(data->surname != NULL);
-    memset(data->surname, 0, (strlen(entry.fields[pos]) + 1) * sizeof(char));
-    csv_getAsString(entry, pos, data->surname, strlen(entry.fields[pos]) + 1);
-    
-    // Copy phone data
-    pos = 3;
-    data->phone = (char*) malloc((strlen(entry.fields[pos]) + 1) * sizeof(char));
-    assert(data->phone != NULL);
-    memset(data->phone, 0, (strlen(entry.fields[pos]) + 1) * sizeof(char));
-    csv_getAsString(entry, pos, data->phone, strlen(entry.fields[pos]) + 1);
-    
-    // Copy email data
-    pos = 4;
-    data->email = (char*) malloc((strlen(entry.fields[pos]) + 1) * sizeof(char));
-    assert(data->email != NULL);
-    memset(data->email, 0, (strlen(entry.fields[pos]) + 1) * sizeof(char));
-    csv_getAsString(entry, pos, data->email, strlen(entry.fields[pos]) + 1);
-    
-    // Copy address data
-    pos = 5;
-    data->address = (char*) malloc((strlen(entry.fields[pos]) + 1) * sizeof(char));
-    assert(data->address != NULL);
-    memset(data->address, 0, (strlen(entry.fields[pos]) + 1) * sizeof(char));
-    csv_getAsString(entry, pos, data->address, strlen(entry.fields[pos]) + 1);
-    
-    // Copy cp data
-    pos = 6;
-    data->cp = (char*) malloc((strlen(entry.fields[pos]) + 1) * sizeof(char));
-    assert(data->cp != NULL);
-    memset(data->cp, 0, (strlen(entry.fields[pos]) + 1) * sizeof(char));
-    csv_getAsString(entry, pos, data->cp, strlen(entry.fields[pos]) + 1);
+    // Copy document, name, surname, phone, email, address and cp data, that are the first fields
+    for (pos = 0; pos < PERSON_NUM_TEXTS; pos++) {
+        texts[pos] = entry.fields[pos];
+    }
+    person_setTexts(data, texts);
     
     // Check birthday lenght
     pos = 7;
     assert(strlen(entry.fields[pos]) == 10);
     // Parse the birthday date
-    sscanf(entry.fields[pos], "%d/%d/%d", &(data->birthday.day), &(data->birthday.month), &(data->birthday.year));
+    date_parse(&(data->birthday), entry.fields[pos]);
 }
 
 // Add a new person to people data
@@ -160,81 +230,134 @@ void people_add(tPeople* data, tPerson person) {
     assert(data != NULL);
     
     // If person does not exist add it
-    if(people_find(data[0], person.document) < 0) {   
-        // Allocate memory for new element
-        if (data->count == 0) {
-            // Request new memory space
-            data->elems = (tPerson*) malloc(sizeof(tPerson));            
-        } else {
-            // Modify currently allocated memory
-            data->elems = (tPerson*) realloc(data->elems, (data->count + 1) * sizeof(tPerson));            
-        }
-        assert(data->elems != NULL);
-        
-        // Initialize the new element
-        person_init(&(data->elems[data->count]));
-                
-        // Copy the data to the new position
-        person_cpy(&(data->elems[data->count]), person);
-        
-        // Increase the number of elements
-        data->count ++;
+    if(people_find_ptr(data, person.document) < 0) {   
+        people_append(data, person);
     }
 }
 
+// Make room for a new person at the end of people data
+static void people_reserve(tPeople* data) {
+    int capacity;
+
+    // Allocate memory for new element, doubling the capacity when it is full
+    if (data->count == data->capacity) {
+        capacity = (data->capacity == 0) ? PEOPLE_INITIAL_CAPACITY : data->capacity * 2;
+        data->elems = (tPerson*) arena_realloc(data->elems, data->capacity * sizeof(tPerson), capacity * sizeof(tPerson));
+        data->capacity = capacity;
+    }
+    assert(data->elems != NULL);
+}
+
+// Count the person stored at the end of people data and add it to the hash index
+static void people_indexLast(tPeople* data) {
+    // Increase the number of elements
+    data->count ++;
+    
+    // Add it to the hash index, making it larger if needed
+    if (2 * data->count > data->indexCapacity) {
+        people_reindex(data);
+    } else {
+        people_indexAdd(data, data->count - 1);
+    }
+}
+
+// Add a new person to people data without checking if it already exists
+void people_append(tPeople* data, tPerson person) {
+    // Check input data
+    assert(data != NULL);
+    
+    people_reserve(data);
+    
+    // Initialize the new element
+    person_init(&(data->elems[data->count]));
+            
+    // Copy the data to the new position
+    person_cpy(&(data->elems[data->count]), person);
+    
+    people_indexLast(data);
+}
+
+// Add a new person to people data without checking if it already exists, taking its texts
+void people_appendMove(tPeople* data, tPerson* person) {
+    // Check input data
+    assert(data != NULL);
+    assert(person != NULL);
+    assert(person->document != NULL);
+    
+    people_reserve(data);
+    
+    // The new position keeps the block of texts, and the person no longer owns it
+    data->elems[data->count] = *person;
+    person_init(person);
+    
+    people_indexLast(data);
+}
+
 // Remove a person from people data
 void people_del(tPeople* data, const char *document) {
-    int i;
-    int pos;
+    int slot;
     
     // Check input data
     assert(data != NULL);
     
     // Find if it exists
-    pos = people_find(data[0], document);
-    
-    if (pos >= 0) {
-        // Remove current position memory
-        person_free(&(data->elems[pos]));
-        // Shift elements 
-        for(i = pos; i < data->count-1; i++) {
-            // Copy address of element on position i+1 to position i
-            data->elems[i] = data->elems[i+1];
-        }
-        // Update the number of elements
-        data->count--;
-        // Resize the used memory
-        if (data->count == 0) {
-            // No element remaining
-            free(data->elems);
-            data->elems = NULL;
-        } else {
-            // Still some elements are remaining
-            data->elems = (tPerson*)realloc(data->elems, data->count * sizeof(tPerson));
+    slot = people_indexFind(data, document);
+    
+    if (slot >= 0) {
+        // Remove current position memory. The empty position keeps the order of the others
+        person_free(&(data->elems[data->index[slot]]));
+        data->index[slot] = PEOPLE_INDEX_REMOVED;
+        data->removed++;
+        
+        // Recover the empty positions when they are more than the used ones
+        if (2 * data->removed > data->count) {
+            people_compact(data);
         }
     }
 }
 
 // Return the position of a person with provided document. -1 if it does not exist
 int people_find(tPeople data, const char* document) {
-    int i;
+    return people_find_ptr(&data, document);
+}
+
+// Return the position of a person with provided document, without copying the people data
+int people_find_ptr(const tPeople* data, const char* document) {
+    int slot;
     
-    for(i = 0; i < data.count; i++) {
-        if(strcmp(data.elems[i].document, document) == 0 ) {
-            return i;
-        }
+    // Check input data
+    assert(data != NULL);
+    
+    slot = people_indexFind(data, document);
+    if (slot < 0) {
+        return -1;
     }
     
-    return -1;
+    return data->index[slot];
+}
+
+// Return the first position from pos that is not empty. data->count if there are no more people
+int people_next(const tPeople* data, int pos) {
+    // Check input data
+    assert(data != NULL);
+    assert(pos >= 0);
+    
+    while (pos < data->count && data->elems[pos].document == NULL) {
+        pos++;
+    }
+    
+    return pos;
 }
 
 // Print the people data
 void people_print(tPeople data) {
     int i;
+    int pos = 0;
     
-    for(i = 0; i < data.count; i++) {
+    // Skip the positions of removed people
+    for(i = people_next(&data, 0); i < data.count; i = people_next(&data, i + 1)) {
         // Print position and document
-        printf("%d;%s;", i, data.elems[i].document);
+        printf("%d;%s;", pos++, data.elems[i].document);
         // Print name and surname
         printf("%s;%s;", data.elems[i].name, data.elems[i].surname);        
         // Print phone and email
@@ -248,44 +371,20 @@ void people_print(tPeople data) {
 
 // Copy the data from the source to destination
 void person_cpy(tPerson* destination, tPerson source) {
+    const char* texts[PERSON_NUM_TEXTS];
     
     // Remove old data
     person_free(destination);
     
-    // Copy identity document data
-    destination->document = (char*) malloc((strlen(source.document) + 1) * sizeof(char));
-    assert(destination->document != NULL);
-    strcpy(destination->document, source.document);
-    
-    // Copy name data
-    destination->name = (char*) malloc((strlen(source.name) + 1) * sizeof(char));
-    assert(destination->name != NULL);
-    strcpy(destination->name, source.name);
-    
-    // Copy surname data
-    destination->surname = (char*) malloc((strlen(source.surname) + 1) * sizeof(char));
-    assert(destination->surname != NULL);
-    strcpy(destination->surname, source.surname);
-    
-    // Copy phone data
-    destination->phone = (char*) malloc((strlen(source.phone) + 1) * sizeof(char));
-    assert(destination->phone != NULL);
-    strcpy(destination->phone, source.phone);
-    
-    // Copy email data
-    destination->email = (char*) malloc((strlen(source.email) + 1) * sizeof(char));
-    assert(destination->email != NULL);
-    strcpy(destination->email, source.email);
-    
-    // Copy address data
-    destination->address = (char*) malloc((strlen(source.address) + 1) * sizeof(char));
-    assert(destination->address != NULL);
-    strcpy(destination->address, source.address);
-    
-    // Copy cp data
-    destination->cp = (char*) malloc((strlen(source.cp) + 1) * sizeof(char));
-    assert(destination->cp != NULL);
-    strcpy(destination->cp, source.cp);
+    // Copy all the texts to a single block
+    texts[0] = source.document;
+    texts[1] = source.name;
+    texts[2] = source.surname;
+    texts[3] = source.phone;
+    texts[4] = source.email;
+    texts[5] = source.address;
+    texts[6] = source.cp;
+    person_setTexts(destination, texts);
     
     // Copy the birthday date
     destination->birthday = source.birthday;
@@ -293,5 +392,13 @@ void person_cpy(tPerson* destination, tPerson source) {
 
 // Return people lenght
 int people_len(tPeople data) {
-    return data.count;
+    return people_len_ptr(&data);
+}
+
+// Return people lenght, without copying the people data
+int people_len_ptr(const tPeople* data) {
+    // Check input data
+    assert(data != NULL);
+    
+    return data->count - data->removed;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "csv.h"
 #include "date.h"
 
+// The texts of a person are stored one after the other in a single block that starts at document,
+// so a person takes one allocation and is released with one free
 typedef struct _tPerson {
     char* document;
     char* name;
@@ -14,9 +16,26 @@ typedef struct _tPerson {
     tDate birthday;
 } tPerson;
 
+// Initial number of positions allocated for people and for the hash index
+#define PEOPLE_INITIAL_CAPACITY 16
+
+// Value of the free and removed positions of the hash index
+#define PEOPLE_INDEX_EMPTY -1
+#define PEOPLE_INDEX_REMOVED -2
+
+// People are stored in insertion order. Removed people leave an empty position (NULL document) that is
+// recovered when more than half of the positions are empty. An open addressing hash table on the document
+// gives the position of each person.
+// Positions go from 0 to count - 1 and are not contiguous: any of them can be empty, so people_len does not
+// bound them. Use people_next to visit the people. A position returned by people_find is valid until the next
+// call to people_del, that can move the people when it recovers the empty positions
 typedef struct _tPeople {
     tPerson* elems;
     int count;
+    int capacity;
+    int removed;
+    int* index;
+    int indexCapacity;
 } tPeople;
 
 // Initialize the people data
@@ -37,19 +56,39 @@ void person_parse(tPerson* data, tCSVEntry entry);
 // Add a new person to people data
 void people_add(tPeople* data, tPerson person);
 
-// Remove a person from people data
+// Add a new person to people data without checking if it already exists
+void people_append(tPeople* data, tPerson person);
+
+// Add a new person to people data without checking if it already exists. The people data takes the texts
+// of the person instead of copying them, and the person is left empty
+void people_appendMove(tPeople* data, tPerson* person);
+
+// Remove a person from people data. Its position is left empty, and the positions of the other people can
+// change if the empty positions are recovered
 void people_del(tPeople* data, const char *document);
 
 // Return the position of a person with provided document. -1 if it does not exist
 int people_find(tPeople data, const char* document);
 
+// Return the position of a person with provided document, without copying the people data. -1 if it does not exist
+int people_find_ptr(const tPeople* data, const char* document);
+
+// Return the first position from pos that is not empty. data->count if there are no more people
+int people_next(const tPeople* data, int pos);
+
 // Print the people data
 void people_print(tPeople data);
 
 // Copy the data from the source to destination
 void person_cpy(tPerson* destination, tPerson source);
 
-// Return people lenght
+// Return people lenght, the number of people without the empty positions
 int people_len(tPeople data);
 
+// Return people lenght, the number of people without the empty positions, without copying the people data
+int people_len_ptr(const tPeople* data);
+
+// Rebuild the hash index from the people stored in elems
+void people_reindex(tPeople* data);
+
 #endif
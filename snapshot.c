@@ -0,0 +1,457 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "snapshot.h"
+#include "symbol.h"
+#include "arena.h"
+#include "nodepool.h"
+#include "weighingindex.h"
+#include "vineyardplot.h"
+#include "weighing.h"
+
+// Length used to store a NULL string
+#define SNAPSHOT_NULL_STRING 0xFFFFFFFFu
+
+// Value used to detect files written with a different byte order
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+
+// Size of the output buffer
+#define SNAPSHOT_WRITE_BUFFER_SIZE (1024 * 1024)
+
+// Read position in a snapshot block
+typedef struct _tSnapshotReader {
+    char* data;
+    size_t size;
+    size_t pos;
+    bool valid;
+} tSnapshotReader;
+
+// Write an unsigned integer
+static void snapshot_writeU32(FILE* fout, uint32_t value) {
+    fwrite(&value, sizeof(uint32_t), 1, fout);
+}
+
+// Write a signed integer
+static void snapshot_writeI32(FILE* fout, int32_t value) {
+    fwrite(&value, sizeof(int32_t), 1, fout);
+}
+
+// Write a string with its length and the end of string character
+static void snapshot_writeString(FILE* fout, const char* text) {
+    uint32_t len;
+
+    if (text == NULL) {
+        snapshot_writeU32(fout, SNAPSHOT_NULL_STRING);
+        return;
+    }
+    len = strlen(text);
+    snapshot_writeU32(fout, len);
+    fwrite(text, sizeof(char), len + 1, fout);
+}
+
+// Write a date
+static void snapshot_writeDate(FILE* fout, tDate date) {
+    snapshot_writeI32(fout, date.day);
+    snapshot_writeI32(fout, date.month);
+    snapshot_writeI32(fout, date.year);
+}
+
+// Write a list of weighings
+static void snapshot_writeWeighings(FILE* fout, tWeighingList list) {
+    tWeighingNode* pNode;
+    uint32_t count = 0;
+
+    for (pNode = list.first; pNode != NULL; pNode = pNode->next) {
+        count++;
+    }
+    snapshot_writeU32(fout, count);
+
+    for (pNode = list.first; pNode != NULL; pNode = pNode->next) {
+        snapshot_writeString(fout, pNode->elem.code);
+        fwrite(&(pNode->elem.weight), sizeof(float), 1, fout);
+        snapshot_writeDate(fout, pNode->elem.harvestDay);
+        snapshot_writeI32(fout, pNode->elem.grapeVariety);
+    }
+}
+
+// Write a vector of vineyardplots with their weighings
+static void snapshot_writeVineyardplots(FILE* fout, tVineyardplotData data) {
+    int i;
+
+    snapshot_writeU32(fout, data.count);
+    for (i = 0; i < data.count; i++) {
+        snapshot_writeString(fout, data.elems[i].code);
+        snapshot_writeString(fout, data.elems[i].doCode);
+        fwrite(&(data.elems[i].weight), sizeof(float), 1, fout);
+        snapshot_writeI32(fout, data.elems[i].grapeVariety);
+        snapshot_writeWeighings(fout, data.elems[i].weights);
+    }
+}
+
+// Write a list of winegrowers with their vineyardplots
+static void snapshot_writeWinegrowers(FILE* fout, tWinegrowerList list) {
+    tWinegrowerNode* pNode;
+
+    snapshot_writeU32(fout, list.count);
+    for (pNode = list.first; pNode != NULL; pNode = pNode->next) {
+        snapshot_writeString(fout, pNode->winegrower.id);
+        snapshot_writeString(fout, pNode->winegrower.document);
+        snapshot_writeDate(fout, pNode->winegrower.registrationDate);
+        snapshot_writeVineyardplots(fout, pNode->winegrower.vineyardplots);
+    }
+}
+
+// Write all the data to a binary snapshot file
+tApiError snapshot_save(tApiData* data, const char* filename) {
+    FILE* fout;
+    char magic[8];
+    int i;
+    bool failed;
+
+    assert(data != NULL);
+    assert(filename != NULL);
+
+    fout = fopen(filename, "wb");
+    if (fout == NULL) {
+        return E_FILE_NOT_FOUND;
+    }
+    setvbuf(fout, NULL, _IOFBF, SNAPSHOT_WRITE_BUFFER_SIZE);
+
+    // Header
+    memset(magic, 0, sizeof(magic));
+    memcpy(magic, SNAPSHOT_MAGIC, strlen(SNAPSHOT_MAGIC));
+    fwrite(magic, sizeof(char), sizeof(magic), fout);
+    snapshot_writeU32(fout, SNAPSHOT_VERSION);
+    snapshot_writeU32(fout, SNAPSHOT_BYTE_ORDER);
+
+    // People, skipping the positions of removed people
+    snapshot_writeU32(fout, people_len_ptr(&(data->people)));
+    for (i = people_next(&(data->people), 0); i < data->people.count; i = people_next(&(data->people), i + 1)) {
+        snapshot_writeString(fout, data->people.elems[i].document);
+        snapshot_writeString(fout, data->people.elems[i].name);
+        snapshot_writeString(fout, data->people.elems[i].surname);
+        snapshot_writeString(fout, data->people.elems[i].phone);
+        snapshot_writeString(fout, data->people.elems[i].email);
+        snapshot_writeString(fout, data->people.elems[i].address);
+        snapshot_writeString(fout, data->people.elems[i].cp);
+        snapshot_writeDate(fout, data->people.elems[i].birthday);
+    }
+
+    // Winegrowers
+    snapshot_writeWinegrowers(fout, data->winegrowers);
+
+    // DOs
+    snapshot_writeU32(fout, data->DOs.count);
+    for (i = 0; i < data->DOs.count; i++) {
+        snapshot_writeString(fout, data->DOs.elems[i].code);
+        snapshot_writeString(fout, data->DOs.elems[i].name);
+        fwrite(&(data->DOs.elems[i].avgCropField), sizeof(double), 1, fout);
+        snapshot_writeWinegrowers(fout, data->DOs.elems[i].winegrowers);
+        snapshot_writeVineyardplots(fout, data->DOs.elems[i].vineyards);
+    }
+
+    failed = ferror(fout) != 0;
+    if (fclose(fout) != 0) {
+        failed = true;
+    }
+
+    return failed ? E_FILE_WRITE_ERROR : E_SUCCESS;
+}
+
+// Copy n bytes from the reader. The reader becomes invalid if there are not enough bytes
+static void snapshot_read(tSnapshotReader* reader, void* dst, size_t n) {
+    if (!reader->valid || reader->size - reader->pos < n) {
+        reader->valid = false;
+        memset(dst, 0, n);
+        return;
+    }
+    memcpy(dst, reader->data + reader->pos, n);
+    reader->pos += n;
+}
+
+// Read an unsigned integer
+static uint32_t snapshot_readU32(tSnapshotReader* reader) {
+    uint32_t value;
+
+    snapshot_read(reader, &value, sizeof(uint32_t));
+    return value;
+}
+
+// Read a signed integer
+static int32_t snapshot_readI32(tSnapshotReader* reader) {
+    int32_t value;
+
+    snapshot_read(reader, &value, sizeof(int32_t));
+    return value;
+}
+
+// Read a number of elements, checking that it is not larger than the remaining data
+static uint32_t snapshot_readCount(tSnapshotReader* reader) {
+    uint32_t count;
+
+    count = snapshot_readU32(reader);
+    if (count > reader->size - reader->pos) {
+        reader->valid = false;
+        return 0;
+    }
+    return count;
+}
+
+// Get a string stored in the snapshot. The string is not copied
+static char* snapshot_readString(tSnapshotReader* reader) {
+    uint32_t len;
+    char* text;
+
+    len = snapshot_readU32(reader);
+    if (!reader->valid || len == SNAPSHOT_NULL_STRING) {
+        return NULL;
+    }
+    if (reader->size - reader->pos <= len || reader->data[reader->pos + len] != '\0') {
+        reader->valid = false;
+        return NULL;
+    }
+    text = reader->data + reader->pos;
+    reader->pos += len + 1;
+
+    return text;
+}
+
+// Read a string and get its symbol
+static char* snapshot_readSymbol(tSnapshotReader* reader) {
+    return (char*) symbol_intern(snapshot_readString(reader));
+}
+
+// Read a date
+static void snapshot_readDate(tSnapshotReader* reader, tDate* date) {
+    date->day = snapshot_readI32(reader);
+    date->month = snapshot_readI32(reader);
+    date->year = snapshot_readI32(reader);
+}
+
+// Restore a list of weighings
+static void snapshot_readWeighings(tSnapshotReader* reader, tWeighingList* list) {
+    tWeighingNode* pNode;
+    uint32_t count, i;
+
+    weighingList_init(list);
+    count = snapshot_readCount(reader);
+    for (i = 0; i < count && reader->valid; i++) {
+        pNode = nodePool_newWeighingNode();
+        assert(pNode != NULL);
+        pNode->elem.code = snapshot_readSymbol(reader);
+        snapshot_read(reader, &(pNode->elem.weight), sizeof(float));
+        snapshot_readDate(reader, &(pNode->elem.harvestDay));
+        pNode->elem.grapeVariety = (tGrapeVariety) snapshot_readI32(reader);
+        // Pack the harvest day kept before the node, as weighingList_add does
+        weighingIndex_day(pNode);
+
+        // Link at the end of the list
+        pNode->next = NULL;
+        pNode->prev = list->last;
+        if (list->last == NULL) {
+            list->first = pNode;
+        } else {
+            list->last->next = pNode;
+        }
+        list->last = pNode;
+    }
+}
+
+// Restore a vector of vineyardplots with their weighings
+static void snapshot_readVineyardplots(tSnapshotReader* reader, tVineyardplotData* data) {
+    tVineyardplot* plot;
+    uint32_t count, i;
+
+    vineyardplotData_init(data);
+    count = snapshot_readCount(reader);
+    if (count == 0) {
+        return;
+    }
+    // Allocate the capacity vineyardplotData_add expects for this count, as it may add more later
+    data->elems = (tVineyardplot*) arena_malloc(arena_vectorCapacity(count) * sizeof(tVineyardplot));
+    assert(data->elems != NULL);
+
+    for (i = 0; i < count && reader->valid; i++) {
+        plot = &(data->elems[i]);
+        plot->code = snapshot_readSymbol(reader);
+        plot->doCode = snapshot_readSymbol(reader);
+        snapshot_read(reader, &(plot->weight), sizeof(float));
+        plot->grapeVariety = (tGrapeVariety) snapshot_readI32(reader);
+        snapshot_readWeighings(reader, &(plot->weights));
+        data->count++;
+    }
+}
+
+// Restore a list of winegrowers with their vineyardplots
+static void snapshot_readWinegrowers(tSnapshotReader* reader, tWinegrowerList* list) {
+    tWinegrowerNode *pNode, *pLast;
+    uint32_t count, i;
+
+    winegrowerList_init(list);
+    pLast = NULL;
+    count = snapshot_readCount(reader);
+    for (i = 0; i < count && reader->valid; i++) {
+        pNode = nodePool_newWinegrowerNode();
+        assert(pNode != NULL);
+        pNode->winegrower.id = snapshot_readSymbol(reader);
+        pNode->winegrower.document = snapshot_readString(reader);
+        snapshot_readDate(reader, &(pNode->winegrower.registrationDate));
+        snapshot_readVineyardplots(reader, &(pNode->winegrower.vineyardplots));
+
+        // The list was stored in order, link at the end
+        pNode->next = NULL;
+        if (pLast == NULL) {
+            list->first = pNode;
+        } else {
+            pLast->next = pNode;
+        }
+        pLast = pNode;
+        list->count++;
+    }
+}
+
+// Restore the data from a binary snapshot file
+tApiError snapshot_load(tApiData* data, const char* filename, bool readOnly) {
+    tSnapshotReader reader;
+    struct stat info;
+    char magic[8];
+    char* code;
+    uint32_t count, i;
+    ssize_t n;
+    size_t pos;
+    int fd;
+
+    assert(data != NULL);
+    assert(filename != NULL);
+    assert(data->snapshot == NULL);
+    assert(arena_current() == &(data->arena));
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return E_FILE_NOT_FOUND;
+    }
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return E_INVALID_SNAPSHOT;
+    }
+
+    // Restored strings point straight into the block. It belongs to the arena, so releasing the
+    // strings is a no-op and the block goes away with the rest of the data
+    if (readOnly) {
+        data->snapshot = (char*) arena_mapFile(&(data->arena), fd, info.st_size);
+        if (data->snapshot == NULL) {
+            close(fd);
+            return E_MEMORY_ERROR;
+        }
+        data->snapshotMapped = true;
+    } else {
+        // Read the whole file in a single block
+        data->snapshot = (char*) arena_malloc(info.st_size);
+        assert(data->snapshot != NULL);
+        for (pos = 0; pos < (size_t) info.st_size; pos += n) {
+            n = read(fd, data->snapshot + pos, info.st_size - pos);
+            if (n <= 0) {
+                snapshot_release(data);
+                close(fd);
+                return E_INVALID_SNAPSHOT;
+            }
+        }
+        data->snapshotMapped = false;
+    }
+    data->snapshotSize = info.st_size;
+    close(fd);
+
+    reader.data = data->snapshot;
+    reader.size = data->snapshotSize;
+    reader.pos = 0;
+    reader.valid = true;
+
+    // Check the header
+    snapshot_read(&reader, magic, sizeof(magic));
+    if (!reader.valid || strncmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0
+            || snapshot_readU32(&reader) != SNAPSHOT_VERSION || snapshot_readU32(&reader) != SNAPSHOT_BYTE_ORDER) {
+        snapshot_release(data);
+        return E_INVALID_SNAPSHOT;
+    }
+
+    // People
+    count = snapshot_readCount(&reader);
+    if (count > 0) {
+        data->people.elems = (tPerson*) arena_malloc(count * sizeof(tPerson));
+        assert(data->people.elems != NULL);
+        data->people.capacity = count;
+    }
+    for (i = 0; i < count && reader.valid; i++) {
+        person_init(&(data->people.elems[i]));
+        data->people.elems[i].document = snapshot_readString(&reader);
+        data->people.elems[i].name = snapshot_readString(&reader);
+        data->people.elems[i].surname = snapshot_readString(&reader);
+        data->people.elems[i].phone = snapshot_readString(&reader);
+        data->people.elems[i].email = snapshot_readString(&reader);
+        data->people.elems[i].address = snapshot_readString(&reader);
+        data->people.elems[i].cp = snapshot_readString(&reader);
+        snapshot_readDate(&reader, &(data->people.elems[i].birthday));
+        data->people.count++;
+    }
+    if (data->people.count == 0 && data->people.elems != NULL) {
+        arena_free(data->people.elems);
+        data->people.elems = NULL;
+        data->people.capacity = 0;
+    }
+    people_reindex(&(data->people));
+
+    // Winegrowers
+    snapshot_readWinegrowers(&reader, &(data->winegrowers));
+    winegrowerIndex_build(&(data->winegrowerIndex), data->winegrowers);
+    vineyardIndex_build(&(data->vineyardIndex), data->winegrowers);
+
+    // DOs
+    count = snapshot_readCount(&reader);
+    if (count > 0) {
+        data->DOs.elems = (tDO*) arena_malloc(count * sizeof(tDO));
+        assert(data->DOs.elems != NULL);
+        data->DOs.capacity = count;
+    }
+    for (i = 0; i < count && reader.valid; i++) {
+        do_initEmpty(&(data->DOs.elems[i]));
+        code = snapshot_readString(&reader);
+        if (code == NULL || !do_checkCode(code)) {
+            reader.valid = false;
+            break;
+        }
+        strcpy(data->DOs.elems[i].code, code);
+        data->DOs.elems[i].name = snapshot_readString(&reader);
+        snapshot_read(&reader, &(data->DOs.elems[i].avgCropField), sizeof(double));
+        snapshot_readWinegrowers(&reader, &(data->DOs.elems[i].winegrowers));
+        winegrowerIndex_build(&(data->DOs.elems[i].winegrowerIndex), data->DOs.elems[i].winegrowers);
+        snapshot_readVineyardplots(&reader, &(data->DOs.elems[i].vineyards));
+        data->DOs.count++;
+    }
+    if (data->DOs.count == 0 && data->DOs.elems != NULL) {
+        arena_free(data->DOs.elems);
+        data->DOs.elems = NULL;
+        data->DOs.capacity = 0;
+    }
+    doData_reindex(&(data->DOs));
+
+    if (!reader.valid) {
+        return E_INVALID_SNAPSHOT;
+    }
+
+    return E_SUCCESS;
+}
+
+// Forget the snapshot block
+void snapshot_release(tApiData* data) {
+    assert(data != NULL);
+
+    // The block is in the arena of the data, it is released with the arena
+    data->snapshot = NULL;
+    data->snapshotSize = 0;
+    data->snapshotMapped = false;
+}
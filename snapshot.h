@@ -0,0 +1,21 @@
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include <stdbool.h>
+#include "error.h"
+#include "api.h"
+
+// Identification and version of the snapshot files
+#define SNAPSHOT_MAGIC "PR3SNAP"
+#define SNAPSHOT_VERSION 1
+
+// Write all the data to a binary snapshot file. E_FILE_WRITE_ERROR if it could not be written completely
+tApiError snapshot_save(tApiData* data, const char* filename);
+
+// Restore the data from a binary snapshot file. The data must be empty and its arena must be the active one
+tApiError snapshot_load(tApiData* data, const char* filename, bool readOnly);
+
+// Forget the snapshot block. It is in the arena of the data, so it is released with the arena
+void snapshot_release(tApiData* data);
+
+#endif
@@ -0,0 +1,364 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include "symbol.h"
+
+// Data stored before the text of each symbol
+typedef struct _tSymbolHeader {
+    uint32_t hash;
+    uint32_t owned;
+} tSymbolHeader;
+
+// Block of memory holding the text of several symbols
+typedef struct _tSymbolBlock {
+    struct _tSymbolBlock* next;
+    size_t used;
+    size_t size;
+    char text[];
+} tSymbolBlock;
+
+// Open addressing hash table of symbols. A full table is replaced by a bigger one, and the replaced ones
+// are kept until the symbols are released. They are only released once the lookups that could be reading
+// them have finished, so lookups without the lock never read a released table
+typedef struct _tSymbolSlots {
+    struct _tSymbolSlots* previous;
+    int capacity;
+    const char* slots[];
+} tSymbolSlots;
+
+// Lookups of a thread that reads the table without the lock. The sequence is odd while a lookup runs.
+// Each reader takes a cache line of its own, so threads do not write the same line on every lookup.
+// A reader is used by a single thread at a time and it is kept for another thread when the thread ends
+typedef struct _tSymbolReader {
+    struct _tSymbolReader* next;
+    unsigned long sequence;
+    int used;
+} __attribute__((aligned(SYMBOL_READER_ALIGNMENT))) tSymbolReader;
+
+// All the symbols of the application. Symbols interned while some tApiData holds the table are owned by
+// the holders and go to their own blocks. The others are kept until the end of the program
+typedef struct _tSymbolTable {
+    tSymbolSlots* current;
+    int count;
+    int holders;
+    tSymbolBlock* blocks;
+    tSymbolBlock* ownedBlocks;
+    tSymbolReader* readers;
+} tSymbolTable;
+
+static tSymbolTable symbol_table = { NULL, 0, 0, NULL, NULL, NULL };
+static pthread_mutex_t symbol_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Reader of the calling thread, and the key that gives it back when the thread ends
+static __thread tSymbolReader* symbol_reader = NULL;
+static pthread_key_t symbol_readerKey;
+static pthread_once_t symbol_readerOnce = PTHREAD_ONCE_INIT;
+
+// Hash of a text (FNV-1a)
+static uint32_t symbol_hash(const char* text) {
+    uint32_t hash = 2166136261u;
+
+    while (*text != '\0') {
+        hash ^= (unsigned char) *text;
+        hash *= 16777619u;
+        text++;
+    }
+
+    return hash;
+}
+
+// Header of a symbol
+static const tSymbolHeader* symbol_header(const char* symbol) {
+    return ((const tSymbolHeader*) symbol) - 1;
+}
+
+// Find a text in a table without the lock. Slots are only filled with release stores, so a symbol read
+// from a slot is complete
+static const char* symbol_lookup(const tSymbolSlots* table, const char* text, uint32_t hash) {
+    const char* symbol;
+    int pos;
+
+    pos = hash & (table->capacity - 1);
+    while ((symbol = __atomic_load_n(&(table->slots[pos]), __ATOMIC_ACQUIRE)) != NULL) {
+        if (symbol_header(symbol)->hash == hash && strcmp(symbol, text) == 0) {
+            return symbol;
+        }
+        pos = (pos + 1) & (table->capacity - 1);
+    }
+
+    return NULL;
+}
+
+// Leave the reader of an ending thread for other threads
+static void symbol_readerExit(void* reader) {
+    __atomic_store_n(&(((tSymbolReader*) reader)->used), 0, __ATOMIC_RELEASE);
+}
+
+// Create the key of the readers
+static void symbol_readerSetup() {
+    int error;
+
+    error = pthread_key_create(&symbol_readerKey, symbol_readerExit);
+    assert(error == 0);
+}
+
+// Get the reader of the calling thread, taking one the first time
+static tSymbolReader* symbol_readerGet() {
+    tSymbolReader* reader;
+
+    if (symbol_reader != NULL) {
+        return symbol_reader;
+    }
+
+    pthread_once(&symbol_readerOnce, symbol_readerSetup);
+    pthread_mutex_lock(&symbol_lock);
+
+    // Use the reader of a thread that ended, or add a new one. Readers are never released, as
+    // symbol_release reads the list
+    for (reader = symbol_table.readers; reader != NULL; reader = reader->next) {
+        if (!__atomic_load_n(&(reader->used), __ATOMIC_ACQUIRE)) {
+            break;
+        }
+    }
+    if (reader == NULL) {
+        reader = (tSymbolReader*) aligned_alloc(SYMBOL_READER_ALIGNMENT, sizeof(tSymbolReader));
+        assert(reader != NULL);
+        reader->sequence = 0;
+        reader->next = symbol_table.readers;
+        symbol_table.readers = reader;
+    }
+    reader->used = 1;
+
+    pthread_mutex_unlock(&symbol_lock);
+
+    pthread_setspecific(symbol_readerKey, reader);
+    symbol_reader = reader;
+
+    return reader;
+}
+
+// Wait until the lookups that were running when the current table was replaced have finished. Called with
+// the lock, after the replacement
+static void symbol_synchronize() {
+    tSymbolReader* reader;
+    unsigned long sequence;
+
+    for (reader = symbol_table.readers; reader != NULL; reader = reader->next) {
+        // A reader in a lookup may be reading a replaced table. Later lookups read the current one
+        sequence = __atomic_load_n(&(reader->sequence), __ATOMIC_SEQ_CST);
+        if (sequence & 1) {
+            while (__atomic_load_n(&(reader->sequence), __ATOMIC_ACQUIRE) == sequence) {
+                sched_yield();
+            }
+        }
+    }
+}
+
+// Get the symbol of a text with the given hash without adding it and without the lock
+static const char* symbol_findHash(const char* text, uint32_t hash) {
+    const tSymbolSlots* table;
+    tSymbolReader* reader;
+    unsigned long sequence;
+    const char* symbol;
+
+    // Mark the lookup as running before reading the table, so symbol_release waits for it. Only this
+    // thread writes the sequence of its reader, so it is stored instead of incremented
+    reader = symbol_readerGet();
+    sequence = reader->sequence;
+    __atomic_store_n(&(reader->sequence), sequence + 1, __ATOMIC_SEQ_CST);
+
+    table = __atomic_load_n(&(symbol_table.current), __ATOMIC_SEQ_CST);
+    symbol = (table != NULL) ? symbol_lookup(table, text, hash) : NULL;
+
+    __atomic_store_n(&(reader->sequence), sequence + 2, __ATOMIC_RELEASE);
+
+    return symbol;
+}
+
+// Free slot of a hash in a table
+static int symbol_freeSlot(const tSymbolSlots* table, uint32_t hash) {
+    int pos;
+
+    pos = hash & (table->capacity - 1);
+    while (table->slots[pos] != NULL) {
+        pos = (pos + 1) & (table->capacity - 1);
+    }
+
+    return pos;
+}
+
+// Create a table of the given capacity with the symbols of the current one. Owned symbols are skipped if
+// keepOwned is false
+static tSymbolSlots* symbol_copyTable(int capacity, bool keepOwned) {
+    tSymbolSlots* table;
+    const char* symbol;
+    int i;
+
+    table = (tSymbolSlots*) calloc(1, sizeof(tSymbolSlots) + capacity * sizeof(const char*));
+    assert(table != NULL);
+    table->capacity = capacity;
+
+    if (symbol_table.current != NULL) {
+        for (i = 0; i < symbol_table.current->capacity; i++) {
+            symbol = symbol_table.current->slots[i];
+            if (symbol != NULL && (keepOwned || !symbol_header(symbol)->owned)) {
+                table->slots[symbol_freeSlot(table, symbol_header(symbol)->hash)] = symbol;
+            }
+        }
+    }
+
+    return table;
+}
+
+// Double the number of slots, placing again all the symbols in a new table
+static void symbol_grow() {
+    tSymbolSlots* table;
+
+    table = symbol_copyTable((symbol_table.current == NULL) ? SYMBOL_TABLE_INITIAL_CAPACITY : symbol_table.current->capacity * 2, true);
+    table->previous = symbol_table.current;
+    __atomic_store_n(&(symbol_table.current), table, __ATOMIC_SEQ_CST);
+}
+
+// Copy a text to the blocks of the table, after its header
+static const char* symbol_store(const char* text, uint32_t hash) {
+    tSymbolBlock** blocks;
+    tSymbolBlock* block;
+    tSymbolHeader* header;
+    size_t len, size;
+
+    // Headers are aligned, so the used space of the blocks is rounded up to the size of a header
+    len = (sizeof(tSymbolHeader) + strlen(text) + 1 + sizeof(tSymbolHeader) - 1) & ~(sizeof(tSymbolHeader) - 1);
+    blocks = (symbol_table.holders > 0) ? &(symbol_table.ownedBlocks) : &(symbol_table.blocks);
+    block = *blocks;
+    if (block == NULL || block->size - block->used < len) {
+        // Long texts get a block of their own
+        size = (len > SYMBOL_BLOCK_SIZE) ? len : SYMBOL_BLOCK_SIZE;
+        block = (tSymbolBlock*) malloc(sizeof(tSymbolBlock) + size);
+        assert(block != NULL);
+        block->used = 0;
+        block->size = size;
+        block->next = *blocks;
+        *blocks = block;
+    }
+
+    header = (tSymbolHeader*) (block->text + block->used);
+    header->hash = hash;
+    header->owned = (symbol_table.holders > 0);
+    strcpy((char*) (header + 1), text);
+    block->used += len;
+
+    return (const char*) (header + 1);
+}
+
+// Get the symbol of a text, adding it to the symbol table if it is not there yet
+const char* symbol_intern(const char* text) {
+    const char* symbol;
+    uint32_t hash;
+    int pos;
+
+    if (text == NULL) {
+        return NULL;
+    }
+
+    // Most texts are already symbols, and they are found without the lock
+    hash = symbol_hash(text);
+    symbol = symbol_findHash(text, hash);
+    if (symbol != NULL) {
+        return symbol;
+    }
+
+    pthread_mutex_lock(&symbol_lock);
+
+    // Keep the load factor under 1/2 so probe sequences stay short
+    if (symbol_table.current == NULL || 2 * (symbol_table.count + 1) > symbol_table.current->capacity) {
+        symbol_grow();
+    }
+
+    // Another thread may have added it after the first lookup
+    symbol = symbol_lookup(symbol_table.current, text, hash);
+    if (symbol == NULL) {
+        symbol = symbol_store(text, hash);
+        pos = symbol_freeSlot(symbol_table.current, hash);
+        __atomic_store_n(&(symbol_table.current->slots[pos]), symbol, __ATOMIC_RELEASE);
+        symbol_table.count++;
+    }
+
+    pthread_mutex_unlock(&symbol_lock);
+
+    return symbol;
+}
+
+// Get the symbol of a text without adding it
+const char* symbol_find(const char* text) {
+    assert(text != NULL);
+
+    return symbol_findHash(text, symbol_hash(text));
+}
+
+// Hold the table, so the symbols interned from now on are owned
+void symbol_acquire() {
+    pthread_mutex_lock(&symbol_lock);
+    symbol_table.holders++;
+    pthread_mutex_unlock(&symbol_lock);
+}
+
+// Stop holding the table. When no one holds it, the owned symbols and the replaced tables are released once
+// the lookups that may read them have finished
+void symbol_release() {
+    tSymbolSlots *table, *nextTable;
+    tSymbolBlock *block, *nextBlock;
+    int i;
+
+    pthread_mutex_lock(&symbol_lock);
+
+    assert(symbol_table.holders > 0);
+    symbol_table.holders--;
+
+    if (symbol_table.holders == 0 && symbol_table.current != NULL) {
+        if (symbol_table.ownedBlocks != NULL) {
+            // The new table only has the symbols that are kept
+            table = symbol_copyTable(symbol_table.current->capacity, false);
+            table->previous = symbol_table.current;
+            __atomic_store_n(&(symbol_table.current), table, __ATOMIC_SEQ_CST);
+            symbol_table.count = 0;
+            for (i = 0; i < table->capacity; i++) {
+                symbol_table.count += (table->slots[i] != NULL);
+            }
+        }
+
+        // Lookups that started before the last replacement may still probe the replaced tables and
+        // the owned symbols in them
+        symbol_synchronize();
+
+        if (symbol_table.ownedBlocks != NULL) {
+            for (block = symbol_table.ownedBlocks; block != NULL; block = nextBlock) {
+                nextBlock = block->next;
+                free(block);
+            }
+            symbol_table.ownedBlocks = NULL;
+        }
+
+        for (table = symbol_table.current->previous; table != NULL; table = nextTable) {
+            nextTable = table->previous;
+            free(table);
+        }
+        symbol_table.current->previous = NULL;
+    }
+
+    pthread_mutex_unlock(&symbol_lock);
+}
+
+// Number of distinct symbols in the table
+int symbol_count() {
+    int count;
+
+    pthread_mutex_lock(&symbol_lock);
+    count = symbol_table.count;
+    pthread_mutex_unlock(&symbol_lock);
+
+    return count;
+}
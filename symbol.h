@@ -0,0 +1,34 @@
+#ifndef __SYMBOL_H__
+#define __SYMBOL_H__
+
+// Initial number of slots of the symbol table. It is always a power of two
+#define SYMBOL_TABLE_INITIAL_CAPACITY 256
+
+// Size of the blocks where the text of the symbols is stored
+#define SYMBOL_BLOCK_SIZE 4096
+
+// Alignment of the data kept for each thread that looks up symbols, the size of a cache line
+#define SYMBOL_READER_ALIGNMENT 64
+
+// Get the symbol of a text, adding it to the symbol table if it is not there yet. Each distinct text has
+// a single symbol, so two symbols are equal only if they are the same pointer. Symbols must not be modified.
+// A symbol added while the table is held lives until the last holder releases it. The others are never
+// released. NULL if the text is NULL
+const char* symbol_intern(const char* text);
+
+// Get the symbol of a text without adding it. NULL if the text was never interned. It does not lock the
+// table, so it can be called from several threads while symbols are added
+const char* symbol_find(const char* text);
+
+// Hold the table. Each tApiData holds it from api_initData to api_freeData
+void symbol_acquire();
+
+// Stop holding the table. The last holder releases the symbols added while the table was held, so it must
+// not be called while other threads use them. Lookups of other symbols can run meanwhile: the tables they
+// may be reading are released after they finish
+void symbol_release();
+
+// Number of distinct symbols in the table
+int symbol_count();
+
+#endif
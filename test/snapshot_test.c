@@ -0,0 +1,126 @@
+// Restore a snapshot and remove the restored data with the usual functions of each module.
+// Build from the root of the repository:
+//   gcc -g -I. test/snapshot_test.c *.c -o snapshot_test -lpthread
+// Usage: snapshot_test [directory for the temporary files]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "api.h"
+#include "snapshot.h"
+
+// Data written to the CSV file the snapshot is made from
+static const char* test_rows[] = {
+    "PERSON;00000001X;Ana;Garcia;600000001;ana@uoc.edu;Street 1;08001;01/01/1980",
+    "PERSON;00000002X;Joan;Puig;600000002;joan@uoc.edu;Street 2;08002;02/02/1981",
+    "PERSON;00000003X;Marta;Vidal;600000003;marta@uoc.edu;Street 3;08003;03/03/1982",
+    "DO;DO0001;Priorat;1.5",
+    "DO;DO0002;Montsant;2.5",
+    "WINEGROWER;08/01/2020;00000001X;W00001;PE-2024-00001;DO0001;1.70;2",
+    "WINEGROWER;09/01/2020;00000002X;W00002;PE-2024-00002;DO0002;2.10;1",
+    "WEIGHING;28/08/2023;C001;21.83;3;PE-2024-00001",
+    "WEIGHING;29/08/2023;C002;12.50;3;PE-2024-00002",
+    NULL
+};
+
+// Number of failed checks
+static int test_failed = 0;
+
+// Report a failed check
+#define TEST_CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            test_failed++; \
+        } \
+    } while (0)
+
+// Write the rows to a CSV file
+static bool test_writeRows(const char* filename) {
+    FILE* fout;
+    int i;
+
+    fout = fopen(filename, "w");
+    if (fout == NULL) {
+        return false;
+    }
+    for (i = 0; test_rows[i] != NULL; i++) {
+        fprintf(fout, "%s\n", test_rows[i]);
+    }
+
+    return fclose(fout) == 0;
+}
+
+// Restore the snapshot and remove the people, winegrowers and DOs one by one
+static void test_restoreAndRemove(const char* snapshot, bool readOnly) {
+    tApiData data;
+    tWinegrowerNode* pNode;
+    tArena* previous;
+    int i, n;
+
+    api_initData(&data);
+    TEST_CHECK(api_loadSnapshot(&data, snapshot, readOnly) == E_SUCCESS);
+    TEST_CHECK(api_peopleCount_ptr(&data) == 3);
+    TEST_CHECK(api_winegrowersCount_ptr(&data) == 2);
+    TEST_CHECK(api_DOCount_ptr(&data) == 2);
+
+    // The restored strings point into the snapshot block, that must not be released by the modules.
+    // The data of the api grows in its arena, as in the api functions
+    previous = arena_enter(&(data.arena));
+    people_del(&(data.people), "00000002X");
+    TEST_CHECK(people_find_ptr(&(data.people), "00000002X") < 0);
+    TEST_CHECK(people_find_ptr(&(data.people), "00000001X") >= 0);
+    TEST_CHECK(people_len_ptr(&(data.people)) == 2);
+    n = 0;
+    for (i = people_next(&(data.people), 0); i < data.people.count; i = people_next(&(data.people), i + 1)) {
+        TEST_CHECK(strcmp(data.people.elems[i].document, "00000002X") != 0);
+        n++;
+    }
+    TEST_CHECK(n == 2);
+    people_del(&(data.people), "00000001X");
+    people_del(&(data.people), "00000003X");
+    TEST_CHECK(people_len_ptr(&(data.people)) == 0);
+
+    for (pNode = data.winegrowers.first; pNode != NULL; pNode = pNode->next) {
+        winegrower_free(&(pNode->winegrower));
+    }
+    for (i = 0; i < data.DOs.count; i++) {
+        do_free(&(data.DOs.elems[i]));
+    }
+    arena_leave(previous);
+
+    TEST_CHECK(api_freeData(&data) == E_SUCCESS);
+}
+
+int main(int argc, char** argv) {
+    char csvFile[256], snapshotFile[256];
+    const char* directory;
+    tApiData data;
+
+    directory = (argc > 1) ? argv[1] : "/tmp";
+    snprintf(csvFile, sizeof(csvFile), "%s/snapshot_test.csv", directory);
+    snprintf(snapshotFile, sizeof(snapshotFile), "%s/snapshot_test.snap", directory);
+
+    if (!test_writeRows(csvFile)) {
+        fprintf(stderr, "can not write %s\n", csvFile);
+        return 1;
+    }
+
+    api_initData(&data);
+    TEST_CHECK(api_loadData(&data, csvFile, true) == E_SUCCESS);
+    TEST_CHECK(api_saveSnapshot(&data, snapshotFile) == E_SUCCESS);
+    api_freeData(&data);
+
+    test_restoreAndRemove(snapshotFile, false);
+    test_restoreAndRemove(snapshotFile, true);
+
+    remove(csvFile);
+    remove(snapshotFile);
+
+    if (test_failed > 0) {
+        fprintf(stderr, "%d checks failed\n", test_failed);
+        return 1;
+    }
+    printf("snapshot_test: all checks passed\n");
+
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "vineyardindex.h"
+#include "arena.h"
+
+// Pack a valid vineyard code (LL-YYYY-NNNNN) in an integer. Zero is never returned
+static uint64_t vineyardIndex_key(const char* code) {
+    uint64_t key;
+    int i;
+
+    // Two uppercase letters
+    key = (code[0] - 'A') * 26 + (code[1] - 'A');
+
+    // Four digits of the year and five of the number
+    for (i = 3; i <= 6; i++) {
+        key = key * 10 + (code[i] - '0');
+    }
+    for (i = 8; i <= 12; i++) {
+        key = key * 10 + (code[i] - '0');
+    }
+
+    return key + 1;
+}
+
+// First slot of the probe sequence of a key
+static int vineyardIndex_slot(uint64_t key, int capacity) {
+    // Fibonacci hashing, using the high bits of the product
+    return (int) ((key * 0x9E3779B97F4A7C15ull) >> 32) & (capacity - 1);
+}
+
+// Double the number of slots, placing again all the entries
+static void vineyardIndex_grow(tVineyardIndex* index) {
+    tVineyardIndexEntry* entries;
+    int capacity, i, pos;
+
+    capacity = (index->capacity == 0) ? VINEYARD_INDEX_INITIAL_CAPACITY : index->capacity * 2;
+    entries = (tVineyardIndexEntry*) arena_calloc(capacity, sizeof(tVineyardIndexEntry));
+    assert(entries != NULL);
+
+    for (i = 0; i < index->capacity; i++) {
+        if (index->entries[i].key != 0) {
+            pos = vineyardIndex_slot(index->entries[i].key, capacity);
+            while (entries[pos].key != 0) {
+                pos = (pos + 1) & (capacity - 1);
+            }
+            entries[pos] = index->entries[i];
+        }
+    }
+
+    if (index->entries != NULL) {
+        arena_free(index->entries);
+    }
+    index->entries = entries;
+    index->capacity = capacity;
+}
+
+// Initialize an empty index
+void vineyardIndex_init(tVineyardIndex* index) {
+    assert(index != NULL);
+
+    index->entries = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
+
+// Remove all data from the index
+void vineyardIndex_free(tVineyardIndex* index) {
+    assert(index != NULL);
+
+    if (index->entries != NULL) {
+        arena_free(index->entries);
+    }
+    vineyardIndex_init(index);
+}
+
+// Add the vineyardplot in the given position of a winegrower to the index
+void vineyardIndex_add(tVineyardIndex* index, tWinegrower* winegrower, int slot) {
+    uint64_t key;
+    int pos;
+
+    assert(index != NULL);
+    assert(winegrower != NULL);
+    assert(slot >= 0 && slot < winegrower->vineyardplots.count);
+    assert(check_vineyard_code(winegrower->vineyardplots.elems[slot].code));
+
+    // Keep the load factor under 1/2 so probe sequences stay short
+    if (2 * (index->count + 1) > index->capacity) {
+        vineyardIndex_grow(index);
+    }
+
+    key = vineyardIndex_key(winegrower->vineyardplots.elems[slot].code);
+    pos = vineyardIndex_slot(key, index->capacity);
+    while (index->entries[pos].key != 0 && index->entries[pos].key != key) {
+        pos = (pos + 1) & (index->capacity - 1);
+    }
+
+    if (index->entries[pos].key == key) {
+        // Several winegrowers have this code. Keep the first one of the list, as a sequential search does
+        if (strcmp(winegrower->id, index->entries[pos].winegrower->id) < 0) {
+            index->entries[pos].winegrower = winegrower;
+            index->entries[pos].slot = slot;
+        }
+    } else {
+        index->entries[pos].key = key;
+        index->entries[pos].winegrower = winegrower;
+        index->entries[pos].slot = slot;
+        index->count++;
+    }
+}
+
+// Index all the vineyardplots of a list of winegrowers, removing previous data
+void vineyardIndex_build(tVineyardIndex* index, tWinegrowerList list) {
+    tWinegrowerNode* pNode;
+    int i;
+
+    assert(index != NULL);
+
+    vineyardIndex_free(index);
+    for (pNode = list.first; pNode != NULL; pNode = pNode->next) {
+        for (i = 0; i < pNode->winegrower.vineyardplots.count; i++) {
+            if (check_vineyard_code(pNode->winegrower.vineyardplots.elems[i].code)) {
+                vineyardIndex_add(index, &(pNode->winegrower), i);
+            }
+        }
+    }
+}
+
+// Find a vineyardplot by code
+tVineyardplot* vineyardIndex_find(const tVineyardIndex* index, const char* code, tWinegrower** winegrower) {
+    uint64_t key;
+    int pos;
+
+    assert(index != NULL);
+    assert(code != NULL);
+
+    if (index->count == 0 || !check_vineyard_code(code)) {
+        return NULL;
+    }
+
+    key = vineyardIndex_key(code);
+    pos = vineyardIndex_slot(key, index->capacity);
+    while (index->entries[pos].key != 0) {
+        if (index->entries[pos].key == key) {
+            if (winegrower != NULL) {
+                *winegrower = index->entries[pos].winegrower;
+            }
+            return &(index->entries[pos].winegrower->vineyardplots.elems[index->entries[pos].slot]);
+        }
+        pos = (pos + 1) & (index->capacity - 1);
+    }
+
+    return NULL;
+}
+
+// Add a vineyardplot to a winegrower if it does not have it yet, and add it to the index
+void vineyardIndex_addVineyardplot(tVineyardIndex* index, tWinegrower* winegrower, tVineyardplot plot) {
+    int count;
+
+    assert(index != NULL);
+    assert(winegrower != NULL);
+
+    count = winegrower->vineyardplots.count;
+    vineyardplotData_add(&(winegrower->vineyardplots), plot);
+    if (winegrower->vineyardplots.count > count) {
+        vineyardIndex_add(index, winegrower, count);
+    }
+}
+
+// Add a vineyardplot to a winegrower if it does not have it yet, and add it to the index, taking the vineyardplot
+void vineyardIndex_addVineyardplotMove(tVineyardIndex* index, tWinegrower* winegrower, tVineyardplot* plot) {
+    tVineyardplotData* data;
+    tWeighingNode* pNode;
+    tApiError error;
+
+    assert(index != NULL);
+    assert(winegrower != NULL);
+    assert(plot != NULL);
+
+    data = &(winegrower->vineyardplots);
+    if (vineyardplotData_find(*data, plot->code) >= 0) {
+        return;
+    }
+
+    // Grow the vineyardplots as vineyardplotData_add does
+    data->elems = (tVineyardplot*) arena_reserve(data->elems, data->count, sizeof(tVineyardplot));
+    assert(data->elems != NULL);
+
+    // The codes are symbols, so the winegrower only has to take the weighings
+    data->elems[data->count] = *plot;
+    if (arena_current() != NULL && plot->weights.first != NULL && !arena_contains(plot->weights.first)) {
+        // The data of an arena only has blocks of the arena, so weighings of the caller outside of it are
+        // copied, and the caller keeps them
+        weighingList_init(&(data->elems[data->count].weights));
+        for (pNode = plot->weights.first; pNode != NULL; pNode = pNode->next) {
+            error = weighingList_add(&(data->elems[data->count].weights), pNode->elem);
+            assert(error == E_SUCCESS);
+        }
+    } else {
+        weighingList_init(&(plot->weights));
+    }
+    plot->code = NULL;
+    plot->doCode = NULL;
+
+    data->count++;
+    vineyardIndex_add(index, winegrower, data->count - 1);
+}
@@ -0,0 +1,49 @@
+#ifndef __VINEYARDINDEX_H__
+#define __VINEYARDINDEX_H__
+
+#include <stdint.h>
+#include "winegrower.h"
+
+// Initial number of slots of the index. It is always a power of two
+#define VINEYARD_INDEX_INITIAL_CAPACITY 64
+
+// Position of a vineyardplot: the winegrower that owns it and its index in the winegrower vineyardplots
+typedef struct _tVineyardIndexEntry {
+    uint64_t key;
+    tWinegrower* winegrower;
+    int slot;
+} tVineyardIndexEntry;
+
+// Open addressing hash table from vineyard code to the vineyardplots of all the winegrowers.
+// Codes are stored as an integer packed from the fixed format checked by check_vineyard_code
+typedef struct _tVineyardIndex {
+    tVineyardIndexEntry* entries;
+    int capacity;
+    int count;
+} tVineyardIndex;
+
+// Initialize an empty index
+void vineyardIndex_init(tVineyardIndex* index);
+
+// Remove all data from the index
+void vineyardIndex_free(tVineyardIndex* index);
+
+// Add the vineyardplot in the given position of a winegrower to the index. If the code is already indexed,
+// the winegrower that comes first in the list (lower id) is kept
+void vineyardIndex_add(tVineyardIndex* index, tWinegrower* winegrower, int slot);
+
+// Index all the vineyardplots of a list of winegrowers, removing previous data
+void vineyardIndex_build(tVineyardIndex* index, tWinegrowerList list);
+
+// Find a vineyardplot by code. If winegrower is not NULL, it gets the winegrower that owns it
+tVineyardplot* vineyardIndex_find(const tVineyardIndex* index, const char* code, tWinegrower** winegrower);
+
+// Add a vineyardplot to a winegrower if it does not have it yet, and add it to the index
+void vineyardIndex_addVineyardplot(tVineyardIndex* index, tWinegrower* winegrower, tVineyardplot plot);
+
+// Add a vineyardplot to a winegrower if it does not have it yet, and add it to the index. The winegrower takes
+// the vineyardplot with its weighings instead of copying it, and the vineyardplot is left empty. With an active
+// arena, weighings that are not in an arena are copied instead, and the vineyardplot keeps them
+void vineyardIndex_addVineyardplotMove(tVineyardIndex* index, tWinegrower* winegrower, tVineyardplot* plot);
+
+#endif
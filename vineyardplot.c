@@ -6,6 +6,8 @@
 #include <ctype.h>
 #include <stdbool.h>
 #include "vineyardplot.h"
+#include "symbol.h"
+#include "arena.h"
     
 
 // Initialize the vineyardplot  data
@@ -14,15 +16,11 @@ tApiError vineyardplot_init(tVineyardplot* vineyardplot, const char* vineyardCod
     assert(vineyardCode != NULL);
     assert(doCode != NULL);
     
-    // Allocate memory and set the vineyard code
-    vineyardplot->code = (char*) malloc(strlen(vineyardCode) + 1);
-    assert(vineyardplot->code != NULL);
-    strcpy(vineyardplot->code, vineyardCode);
+    // Set the vineyard code. It is a symbol, so copies of the vineyardplot do not allocate it again
+    vineyardplot->code = (char*) symbol_intern(vineyardCode);
 
-    // Allocate memory and set the DO code
-    vineyardplot->doCode = (char*) malloc(strlen(doCode) + 1);
-    assert(vineyardplot->doCode != NULL);
-    strcpy(vineyardplot->doCode, doCode);
+    // Set the DO code. It is a symbol, shared by all the vineyardplots of the DO
+    vineyardplot->doCode = (char*) symbol_intern(doCode);
 
     // Set the weight
     vineyardplot->weight = weight;
@@ -40,15 +38,9 @@ tApiError vineyardplot_init(tVineyardplot* vineyardplot, const char* vineyardCod
 void vineyardplot_free(tVineyardplot* plot){
     assert(plot != NULL);
     
-    if (plot->code != NULL) {
-        free(plot->code);
-        plot->code = NULL; 
-    }
-
-    if (plot->doCode != NULL) {
-        free(plot->doCode);
-        plot->doCode = NULL;
-    }
+    // The codes are symbols, they are not released
+    plot->code = NULL;
+    plot->doCode = NULL;
     
     weighingList_free(&(plot->weights));
 }
@@ -85,11 +77,8 @@ void vineyardplotData_add(tVineyardplotData* data, tVineyardplot plot){
     
     // If it does not exist, create a new entry
     if (idx < 0) {    
-        if (data->elems == NULL) {
-            data->elems = (tVineyardplot*) malloc(sizeof(tVineyardplot));
-        } else {
-            data->elems = (tVineyardplot*) realloc(data->elems, (data->count + 1) * sizeof(tVineyardplot));
-        }
+        // The vector only keeps its count, so its capacity is the one arena_reserve gives to that count
+        data->elems = (tVineyardplot*) arena_reserve(data->elems, data->count, sizeof(tVineyardplot));
         assert(data->elems != NULL);        
         vineyardplot_cpy(&(data->elems[data->count]), plot);
         data->count ++;        
@@ -99,12 +88,19 @@ void vineyardplotData_add(tVineyardplotData* data, tVineyardplot plot){
 
 // Return the position of a vineyardplot with provided information. -1 if it does not exist
 int vineyardplotData_find(tVineyardplotData data, const char* code) {
+    const char* symbol;
     int i;
     
     assert(code != NULL);
     
+    // Codes of the vineyardplots are symbols. If the code has no symbol, no vineyardplot has it
+    symbol = symbol_find(code);
+    if (symbol == NULL) {
+        return -1;
+    }
+    
     for(i = 0; i < data.count; i++) {
-        if(strcmp(data.elems[i].code, code) == 0) {
+        if(data.elems[i].code == symbol) {
             return i;
         }
     }
@@ -122,7 +118,7 @@ void vineyardplotData_free(tVineyardplotData* data) {
         for(i=0; i < data->count; i++) {
             vineyardplot_free(&(data->elems[i]));
         }
-        free(data->elems);
+        arena_free(data->elems);
         vineyardplotData_init(data);    
         }
     }    
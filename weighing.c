@@ -5,6 +5,10 @@
 #include "weighing.h"
 #include "vineyardplot.h"
 #include "grapevariety.h"
+#include "symbol.h"
+#include "arena.h"
+#include "nodepool.h"
+#include "weighingindex.h"
 
 // Initialize a weighing
 tApiError weighing_init(tWeighing* weighing, const char* code, float weight, tDate harvestDay, tGrapeVariety grapeVariety) {
@@ -13,16 +17,10 @@ tApiError weighing_init(tWeighing* weighing, const char* code, float weight, tDa
     assert(weighing != NULL);
     assert(code != NULL);
     
-    // Allocate the memory for the code
-    weighing->code = (char*)malloc(sizeof(char) * (strlen(code) + 1));
-    
-    if (weighing->code == NULL)
-    {
-        return E_MEMORY_ERROR;
-    }
+    // Use the symbol of the code, shared by all the weighings with this code
+    weighing->code = (char*) symbol_intern(code);
     
     // Assign all weighing properties
-    strcpy(weighing->code, code);
     weighing->weight = weight;
     date_cpy(&(weighing->harvestDay), harvestDay);
     
@@ -40,9 +38,12 @@ tApiError weighing_cpy(tWeighing* dst, tWeighing src)
     // Preconditions
     assert(dst != NULL);
     
-    // Initialize all values with init function
+    // The code of a weighing is always a symbol and it owns no other memory, so the copy shares the code
+    // instead of looking it up again in the symbol table
     // PR3 EX 1d-2
-    return weighing_init(dst, src.code, src.weight, src.harvestDay, src.grapeVariety);
+    *dst = src;
+    
+    return E_SUCCESS;
 }
 
 // Release a weighing
@@ -51,11 +52,8 @@ void weighing_free(tWeighing* weighing)
     // Preconditions
     assert(weighing != NULL);
     
-    // Release the memory allocated in init function
-    if (weighing->code != NULL) {
-        free(weighing->code);
-        weighing->code = NULL;
-    }
+    // The code is a symbol, it is not released
+    weighing->code = NULL;
 }
 
 // Initialize a weighing list
@@ -87,78 +85,110 @@ bool weighingList_empty(tWeighingList list)
 tApiError weighingList_add(tWeighingList* list, tWeighing weighing)
 {
     // PR2 EX 1c
-    tWeighingNode *pNode = NULL, *pPrev = NULL;
+    tWeighingNode *pNode = NULL, *pPrev = NULL, *pFound = NULL;
+    tWeighingIndex* index;
+    tWeighingIndexPos pos;
+    tPackedDate day;
+    int cmp = 1;
+    int steps = 0;
     
     // Preconditions
     assert(list != NULL);
     
-    if (weighingList_empty(*list))
+    day = date_pack(weighing.harvestDay);
+    index = weighingIndex_get(list);
+    
+    if (list->last != NULL && weighingIndex_cmp(list->last, day, weighing.code) < 0)
     {
-        // Create the new node
-        pNode = weighingList_createNode(weighing);
-        
-        if (pNode == NULL)
+        // Most weighings arrive sorted by day, so they go after the last node
+        pPrev = list->last;
+        if (index != NULL)
         {
-            return E_MEMORY_ERROR;
+            pos.chunk = index->count - 1;
+            pos.entry = index->chunks[pos.chunk]->count;
+        }
+    }
+    else if (index != NULL)
+    {
+        // Long lists with weighings out of order find the node with the same day and code, or the last one
+        // that goes before, in their index
+        pos = weighingIndex_find(index, day, weighing.code, &pFound);
+        pPrev = pFound != NULL ? pFound : weighingIndex_prev(index, pos);
+        cmp = pFound != NULL ? 0 : -1;
+    }
+    else
+    {
+        // Otherwise the position is searched from the end of the list. In the same pass, stop at the node
+        // with the same day and code, or at the last one that goes before
+        pPrev = list->last;
+        while (pPrev != NULL && (cmp = weighingIndex_cmp(pPrev, day, weighing.code)) > 0) {
+            pPrev = pPrev->prev;
+            steps++;
+        }
+    }
+    
+    // If the node already exists, update its weight
+    if (pPrev != NULL && cmp == 0)
+    {
+        pPrev->elem.weight += weighing.weight;
+        return E_SUCCESS;
+    }
+    
+    // Create a new node for this day and code
+    pNode = weighingList_createNode(weighing);
+    
+    if (pNode == NULL)
+    {
+        return E_MEMORY_ERROR;
+    }
+    NODE_POOL_WEIGHING_HEADER(pNode)->day = day;
+    
+    // If pPrev is NULL, the new node has to be pointer at the beginning
+    if (pPrev == NULL)
+    {
+        pNode->next = list->first;
+        pNode->prev = NULL;
+        if (list->first != NULL)
+        {
+            list->first->prev = pNode;
+        }
+        else
+        {
+            list->last = pNode;
         }
-        
-        // Point the created node to the first and last node at the same time
         list->first = pNode;
-        list->last = pNode;
     }
     else
     {
-        // Check if there is a node for that day and code
-        pNode = weighingList_findNode(*list, weighing.code, weighing.harvestDay);
+        // Link all pointers of the current, previous and next node
+        if (pPrev->next != NULL)
+        {
+            pPrev->next->prev = pNode;
+        }
+        
+        pNode->next = pPrev->next;
+        pNode->prev = pPrev;
+        pPrev->next = pNode;
         
-        // If the node already exists, update its weight
-        if (pNode != NULL)
+        // Check if the previous node is the current last node and update it
+        if (list->last == pPrev)
         {
-            pNode->elem.weight += weighing.weight;
+            list->last = pNode;
         }
-        else
+    }
+    
+    // Keep the index up to date. A list without one gets it when a weighing had to go far from the end
+    if (index != NULL)
+    {
+        if (!weighingIndex_insert(index, list, pos, pNode))
         {
-            // Create a new node for this day and code
-            pNode = weighingList_createNode(weighing);
-            
-            if (pNode == NULL)
-            {
-                return E_MEMORY_ERROR;
-            }
-            
-            // Find the previous node to insert the new node
-            pPrev = weighingList_findPrev(*list, weighing.code, weighing.harvestDay);
-            
-            // If pPrev is NULL, the new node has to be pointer at the beginning
-            if (pPrev == NULL)
-            {
-                // No condition needed to check if list->first is NULL
-                // This scope assume that the list is not empty
-                list->first->prev = pNode;
-                pNode->next = list->first;
-                pNode->prev = NULL;
-                list->first = pNode;
-            }
-            else
-            {
-                // Link all pointers of the current, previous and next node
-                if (pPrev->next != NULL)
-                {
-                    pPrev->next->prev = pNode;
-                }
-                
-                pNode->next = pPrev->next;
-                pNode->prev = pPrev;
-                pPrev->next = pNode;
-                
-                // Check if the previous node is the current last node and update it
-                if (list->last == pPrev)
-                {
-                    list->last = pNode;
-                }
-            }
+            weighingIndex_free(list);
         }
     }
+    else if (steps > WEIGHING_INDEX_MIN_STEPS)
+    {
+        weighingIndex_build(list);
+    }
     
     return E_SUCCESS;
     /////////////////////////////////
@@ -171,6 +201,8 @@ double weighingList_getWeight(tWeighingList list, const char* code, tDate day)
     // PR2 EX 1d
     double totalWeight;
     tWeighingNode *pNode = NULL;
+    const char* symbol;
+    tPackedDate packed;
     
     // Preconditions
     assert(code != NULL);
@@ -178,12 +210,19 @@ double weighingList_getWeight(tWeighingList list, const char* code, tDate day)
     // Initialize the summatory
     totalWeight = 0.0;
     
+    // Codes of the weighings are symbols. If the code has no symbol, no weighing has it
+    symbol = symbol_find(code);
+    if (symbol == NULL) {
+        return totalWeight;
+    }
+    
     // Get the first node to start
     pNode = list.first;
+    packed = date_pack(day);
     
-    // Iterate until the day received or the end of the list
-    while (pNode != NULL && date_cmp(pNode->elem.harvestDay, day) <= 0) {
-        if (strcmp(pNode->elem.code, code) == 0) {
+    // Iterate until the day received or the end of the list, comparing the packed days of the nodes
+    while (pNode != NULL && weighingIndex_nodeDay(pNode) <= packed) {
+        if (pNode->elem.code == symbol) {
             totalWeight += pNode->elem.weight;
         }
         
@@ -204,6 +243,9 @@ void weighingList_free(tWeighingList* list)
     // Preconditions
     assert(list != NULL);
     
+    // Release the index kept in the first node
+    weighingIndex_free(list);
+    
     // Get the first node to release
     pNode = list->first;
     
@@ -216,7 +258,7 @@ void weighingList_free(tWeighingList* list)
         weighing_free(&(pNode->elem));
         
         // Release the allocated memory for the node
-        free(pNode);
+        nodePool_freeWeighingNode(pNode);
         
         // Prepare pNode for the next iteration with the current first node
         pNode = list->first;
@@ -235,7 +277,7 @@ tWeighingNode* weighingList_createNode(tWeighing weighing)
     tWeighingNode* pNode = NULL;
     
     // Allocate memory for the node
-    pNode = (tWeighingNode*)malloc(sizeof(tWeighingNode));
+    pNode = nodePool_newWeighingNode();
     
     if (pNode == NULL)
     {
@@ -254,17 +296,27 @@ tWeighingNode* weighingList_createNode(tWeighing weighing)
 tWeighingNode* weighingList_findNode(tWeighingList list, const char* code, tDate harvestDay)
 {
     tWeighingNode* pNode = NULL;
+    const char* symbol;
+    tPackedDate packed;
+    int cmp;
     
     // Preconditions
     assert(code != NULL);
     
+    // Codes of the weighings are symbols. If the code has no symbol, no weighing has it
+    symbol = symbol_find(code);
+    if (symbol == NULL) {
+        return NULL;
+    }
+    
     // Get the first node to start to find
     pNode = list.first;
+    packed = date_pack(harvestDay);
     
     // Iterate through the doubly linked list until the node is found or passed
     // (according to its harving day and code)
-    while (pNode != NULL && date_cmp(pNode->elem.harvestDay, harvestDay) <= 0) {
-        if (date_cmp(pNode->elem.harvestDay, harvestDay) == 0 && strcmp(pNode->elem.code, code) == 0) {
+    while (pNode != NULL && (cmp = date_cmpPacked(weighingIndex_nodeDay(pNode), packed)) <= 0) {
+        if (pNode->elem.code == symbol && cmp == 0) {
             return pNode;
         }
         
@@ -279,18 +331,19 @@ tWeighingNode* weighingList_findNode(tWeighingList list, const char* code, tDate
 tWeighingNode* weighingList_findPrev(tWeighingList list, const char* code, tDate harvestDay)
 {
     tWeighingNode *pNode = NULL;
+    tPackedDate packed;
     
     // Preconditions
     assert(code != NULL);
     
     // Iterate the list to find the previous node to insert the new one
     pNode = list.first;
+    packed = date_pack(harvestDay);
     
     // Find the node and return the previous one
     while (pNode != NULL)
     {
-        if (date_cmp(pNode->elem.harvestDay, harvestDay) > 0 
-            || (date_cmp(pNode->elem.harvestDay, harvestDay) == 0 && strcmp(pNode->elem.code, code) > 0))
+        if (weighingIndex_cmp(pNode, packed, code) > 0)
         {
             return pNode->prev;
         }
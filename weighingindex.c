@@ -0,0 +1,290 @@
+#include <string.h>
+#include <assert.h>
+#include "weighingindex.h"
+#include "arena.h"
+
+// Get the packed harvest day of a node of a weighing list
+tPackedDate weighingIndex_day(tWeighingNode* node) {
+    tWeighingNodeHeader* header;
+
+    assert(node != NULL);
+
+    // Nodes linked by other means than weighingList_add, such as the ones of a snapshot, are packed here
+    header = NODE_POOL_WEIGHING_HEADER(node);
+    if (header->day == 0) {
+        header->day = date_pack(node->elem.harvestDay);
+    }
+
+    return header->day;
+}
+
+// Get the packed harvest day of a node of a weighing list without storing it
+tPackedDate weighingIndex_nodeDay(const tWeighingNode* node) {
+    tPackedDate day;
+
+    assert(node != NULL);
+
+    day = NODE_POOL_WEIGHING_HEADER(node)->day;
+
+    return day != 0 ? day : date_pack(node->elem.harvestDay);
+}
+
+// Compare the key of a node with the given day and code
+int weighingIndex_cmp(tWeighingNode* node, tPackedDate day, const char* code) {
+    tPackedDate nodeDay;
+
+    assert(node != NULL);
+    assert(code != NULL);
+
+    nodeDay = weighingIndex_day(node);
+    if (nodeDay != day) {
+        return date_cmpPacked(nodeDay, day);
+    }
+
+    // Codes are symbols, so most equal codes are the same pointer
+    return node->elem.code == code ? 0 : strcmp(node->elem.code, code);
+}
+
+// Compare the key of an entry with the given day and code
+static int weighingIndex_cmpEntry(const tWeighingIndexEntry* entry, tPackedDate day, const char* code) {
+    if (entry->day != day) {
+        return date_cmpPacked(entry->day, day);
+    }
+
+    return entry->code == code ? 0 : strcmp(entry->code, code);
+}
+
+// Add a chunk to the index at the given position
+static tWeighingIndexChunk* weighingIndex_addChunk(tWeighingIndex* index, int pos) {
+    tWeighingIndexChunk** chunks;
+    tWeighingIndexChunk* chunk;
+
+    chunk = (tWeighingIndexChunk*) arena_malloc(sizeof(tWeighingIndexChunk));
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunks = (tWeighingIndexChunk**) arena_reserve(index->chunks, index->count, sizeof(tWeighingIndexChunk*));
+    if (chunks == NULL) {
+        arena_free(chunk);
+        return NULL;
+    }
+    index->chunks = chunks;
+
+    memmove(&(index->chunks[pos + 1]), &(index->chunks[pos]), (index->count - pos) * sizeof(tWeighingIndexChunk*));
+    index->chunks[pos] = chunk;
+    index->count++;
+    chunk->count = 0;
+
+    return chunk;
+}
+
+// Release the chunks and the index
+static void weighingIndex_release(tWeighingIndex* index) {
+    int i;
+
+    for (i = 0; i < index->count; i++) {
+        arena_free(index->chunks[i]);
+    }
+    arena_free(index->chunks);
+    arena_free(index);
+}
+
+// Get the index of a list
+tWeighingIndex* weighingIndex_get(tWeighingList* list) {
+    tWeighingIndex* index;
+
+    assert(list != NULL);
+
+    if (list->first == NULL) {
+        return NULL;
+    }
+
+    // A list that got nodes at its end by other means has an index that misses them
+    index = NODE_POOL_WEIGHING_HEADER(list->first)->index;
+    if (index != NULL && index->last != list->last) {
+        weighingIndex_free(list);
+        index = NULL;
+    }
+
+    return index;
+}
+
+// Index all the nodes of a list
+tWeighingIndex* weighingIndex_build(tWeighingList* list) {
+    tWeighingIndex* index;
+    tWeighingIndexChunk* chunk;
+    tWeighingIndexEntry* entry;
+    tWeighingNode* pNode;
+
+    assert(list != NULL);
+
+    weighingIndex_free(list);
+    if (list->first == NULL) {
+        return NULL;
+    }
+
+    index = (tWeighingIndex*) arena_malloc(sizeof(tWeighingIndex));
+    if (index == NULL) {
+        return NULL;
+    }
+    index->chunks = NULL;
+    index->count = 0;
+    index->last = list->last;
+
+    // The nodes are in order, so they fill the chunks one after another
+    chunk = NULL;
+    for (pNode = list->first; pNode != NULL; pNode = pNode->next) {
+        if (chunk == NULL || chunk->count == WEIGHING_INDEX_CHUNK_SIZE) {
+            chunk = weighingIndex_addChunk(index, index->count);
+            if (chunk == NULL) {
+                weighingIndex_release(index);
+                return NULL;
+            }
+        }
+        entry = &(chunk->entries[chunk->count++]);
+        entry->day = weighingIndex_day(pNode);
+        entry->code = pNode->elem.code;
+        entry->node = pNode;
+    }
+
+    NODE_POOL_WEIGHING_HEADER(list->first)->index = index;
+
+    return index;
+}
+
+// Find the position of the first node of the index that does not go before the given day and code
+tWeighingIndexPos weighingIndex_find(const tWeighingIndex* index, tPackedDate day, const char* code,
+    tWeighingNode** found) {
+    tWeighingIndexPos pos;
+    tWeighingIndexChunk* chunk;
+    int low, high, mid;
+
+    assert(index != NULL);
+    assert(index->count > 0);
+    assert(code != NULL);
+
+    if (found != NULL) {
+        *found = NULL;
+    }
+
+    // First chunk whose last entry does not go before the key
+    low = 0;
+    high = index->count;
+    while (low < high) {
+        mid = (low + high) / 2;
+        chunk = index->chunks[mid];
+        if (weighingIndex_cmpEntry(&(chunk->entries[chunk->count - 1]), day, code) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    // The key goes after all the nodes
+    if (low == index->count) {
+        pos.chunk = index->count - 1;
+        pos.entry = index->chunks[pos.chunk]->count;
+        return pos;
+    }
+
+    // First entry of the chunk that does not go before the key
+    pos.chunk = low;
+    chunk = index->chunks[low];
+    low = 0;
+    high = chunk->count - 1;
+    while (low < high) {
+        mid = (low + high) / 2;
+        if (weighingIndex_cmpEntry(&(chunk->entries[mid]), day, code) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    pos.entry = low;
+
+    if (found != NULL && weighingIndex_cmpEntry(&(chunk->entries[low]), day, code) == 0) {
+        *found = chunk->entries[low].node;
+    }
+
+    return pos;
+}
+
+// Get the node just before a position of the index
+tWeighingNode* weighingIndex_prev(const tWeighingIndex* index, tWeighingIndexPos pos) {
+    tWeighingIndexChunk* chunk;
+
+    assert(index != NULL);
+
+    if (pos.entry > 0) {
+        return index->chunks[pos.chunk]->entries[pos.entry - 1].node;
+    }
+    if (pos.chunk > 0) {
+        chunk = index->chunks[pos.chunk - 1];
+        return chunk->entries[chunk->count - 1].node;
+    }
+
+    return NULL;
+}
+
+// Add a node linked in the list at a position of its index
+bool weighingIndex_insert(tWeighingIndex* index, tWeighingList* list, tWeighingIndexPos pos, tWeighingNode* node) {
+    tWeighingIndexChunk *chunk, *next;
+    tWeighingIndexEntry* entry;
+    int half;
+
+    assert(index != NULL);
+    assert(list != NULL);
+    assert(node != NULL);
+
+    // A full chunk is split in two halves, so the entries moved by an insert are at most a chunk
+    chunk = index->chunks[pos.chunk];
+    if (chunk->count == WEIGHING_INDEX_CHUNK_SIZE) {
+        next = weighingIndex_addChunk(index, pos.chunk + 1);
+        if (next == NULL) {
+            return false;
+        }
+        half = WEIGHING_INDEX_CHUNK_SIZE / 2;
+        memcpy(next->entries, &(chunk->entries[half]), (chunk->count - half) * sizeof(tWeighingIndexEntry));
+        next->count = chunk->count - half;
+        chunk->count = half;
+        if (pos.entry > half) {
+            pos.chunk++;
+            pos.entry -= half;
+            chunk = next;
+        }
+    }
+
+    memmove(&(chunk->entries[pos.entry + 1]), &(chunk->entries[pos.entry]),
+        (chunk->count - pos.entry) * sizeof(tWeighingIndexEntry));
+    entry = &(chunk->entries[pos.entry]);
+    entry->day = weighingIndex_day(node);
+    entry->code = node->elem.code;
+    entry->node = node;
+    chunk->count++;
+    index->last = list->last;
+
+    // The index is kept in the first node of the list
+    if (node == list->first && node->next != NULL) {
+        NODE_POOL_WEIGHING_HEADER(node->next)->index = NULL;
+        NODE_POOL_WEIGHING_HEADER(node)->index = index;
+    }
+
+    return true;
+}
+
+// Release the index of a list
+void weighingIndex_free(tWeighingList* list) {
+    tWeighingNodeHeader* header;
+
+    assert(list != NULL);
+
+    if (list->first == NULL) {
+        return;
+    }
+
+    header = NODE_POOL_WEIGHING_HEADER(list->first);
+    if (header->index != NULL) {
+        weighingIndex_release(header->index);
+        header->index = NULL;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef __WEIGHINGINDEX_H__
+#define __WEIGHINGINDEX_H__
+
+#include <stdbool.h>
+#include "nodepool.h"
+
+// Number of nodes weighingList_add can step back from the end of a list without an index. A list where
+// a weighing goes further back gets an index
+#define WEIGHING_INDEX_MIN_STEPS 32
+
+// Number of entries of each chunk of an index
+#define WEIGHING_INDEX_CHUNK_SIZE 64
+
+// Key of a node of a weighing list, in the order of the list: packed harvest day, then code
+typedef struct _tWeighingIndexEntry {
+    tPackedDate day;
+    const char* code;
+    tWeighingNode* node;
+} tWeighingIndexEntry;
+
+// Sorted run of consecutive entries of an index
+typedef struct _tWeighingIndexChunk {
+    int count;
+    tWeighingIndexEntry entries[WEIGHING_INDEX_CHUNK_SIZE];
+} tWeighingIndexChunk;
+
+// Ordered index of the nodes of a weighing list, as a sorted array of chunks. It is kept in the header of
+// the first node of the list and it is valid while the last node of the list is the one it has. The vector
+// of chunks only keeps its count and grows with arena_reserve
+typedef struct _tWeighingIndex {
+    tWeighingIndexChunk** chunks;
+    int count;
+    tWeighingNode* last;
+} tWeighingIndex;
+
+// Position in an index: a chunk and an entry of the chunk
+typedef struct _tWeighingIndexPos {
+    int chunk;
+    int entry;
+} tWeighingIndexPos;
+
+// Get the packed harvest day of a node of a weighing list, packing it on first use
+tPackedDate weighingIndex_day(tWeighingNode* node);
+
+// Get the packed harvest day of a node of a weighing list without storing it, for the functions that only
+// read the list
+tPackedDate weighingIndex_nodeDay(const tWeighingNode* node);
+
+// Compare the key of a node with the given day and code
+int weighingIndex_cmp(tWeighingNode* node, tPackedDate day, const char* code);
+
+// Get the index of a list. Return NULL if the list has no index or it was changed without updating it,
+// releasing it in that case
+tWeighingIndex* weighingIndex_get(tWeighingList* list);
+
+// Index all the nodes of a list, replacing its previous index
+tWeighingIndex* weighingIndex_build(tWeighingList* list);
+
+// Find the position of the first node of the index that does not go before the given day and code.
+// If found is not NULL, it gets the node with the same day and code, or NULL
+tWeighingIndexPos weighingIndex_find(const tWeighingIndex* index, tPackedDate day, const char* code,
+    tWeighingNode** found);
+
+// Get the node just before a position of the index, or NULL if it is the first one
+tWeighingNode* weighingIndex_prev(const tWeighingIndex* index, tWeighingIndexPos pos);
+
+// Add a node linked in the list at a position of its index. The index moves to the first node of the list
+// if the node is the new first one
+bool weighingIndex_insert(tWeighingIndex* index, tWeighingList* list, tWeighingIndexPos pos, tWeighingNode* node);
+
+// Release the index of a list
+void weighingIndex_free(tWeighingList* list);
+
+#endif
@@ -0,0 +1,372 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "weighingstore.h"
+#include "arena.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define WEIGHING_STORE_X86
+#endif
+
+// Sum of the weights of the weighings with a packed day in [first, last)
+typedef double (*tWeighingStoreFunc)(const int* days, const float* weights, int count, int first, int last);
+
+// Number of the weighings with a packed day in [first, last) and the given variety, marking their plots
+typedef int (*tWeighingStoreCountFunc)(const int* days, const unsigned char* varieties, const int* plots, int count,
+    int first, int last, int variety, bool* marks);
+
+// Scalar sum, also used for the last weighings of the vector versions
+static double weighingStore_runScalar(const int* days, const float* weights, int count, int first, int last) {
+    double sum;
+    int i;
+
+    sum = 0.0;
+    for (i = 0; i < count; i++) {
+        if (days[i] >= first && days[i] < last) {
+            sum += weights[i];
+        }
+    }
+
+    return sum;
+}
+
+// Scalar count, also used for the last weighings of the vector versions
+static int weighingStore_countScalar(const int* days, const unsigned char* varieties, const int* plots, int count,
+    int first, int last, int variety, bool* marks) {
+    int matches;
+    int i;
+
+    matches = 0;
+    for (i = 0; i < count; i++) {
+        if (days[i] >= first && days[i] < last && varieties[i] == variety) {
+            if (marks != NULL) {
+                marks[plots[i]] = true;
+            }
+            matches++;
+        }
+    }
+
+    return matches;
+}
+
+// Mark the plots of the weighings of a block with its bit set in a mask
+static void weighingStore_mark(const int* plots, unsigned int mask, bool* marks) {
+    while (mask != 0) {
+        marks[plots[__builtin_ctz(mask)]] = true;
+        mask &= mask - 1;
+    }
+}
+
+#ifdef WEIGHING_STORE_X86
+
+// Sum of 4 weighings at a time using SSE2
+__attribute__((target("sse2")))
+static double weighingStore_runSSE2(const int* days, const float* weights, int count, int first, int last) {
+    __m128i lower, upper, day, mask;
+    __m128 weight;
+    __m128d acc;
+    double lanes[2];
+    int i;
+
+    lower = _mm_set1_epi32(first - 1);
+    upper = _mm_set1_epi32(last);
+    acc = _mm_setzero_pd();
+
+    for (i = 0; i + 4 <= count; i += 4) {
+        day = _mm_loadu_si128((const __m128i*) (days + i));
+        mask = _mm_and_si128(_mm_cmpgt_epi32(day, lower), _mm_cmpgt_epi32(upper, day));
+        weight = _mm_and_ps(_mm_loadu_ps(weights + i), _mm_castsi128_ps(mask));
+
+        // Add in double precision, as the scalar version does
+        acc = _mm_add_pd(acc, _mm_cvtps_pd(weight));
+        acc = _mm_add_pd(acc, _mm_cvtps_pd(_mm_movehl_ps(weight, weight)));
+    }
+
+    _mm_storeu_pd(lanes, acc);
+    return (lanes[0] + lanes[1]) + weighingStore_runScalar(days + i, weights + i, count - i, first, last);
+}
+
+// Sum of 8 weighings at a time using AVX2
+__attribute__((target("avx2")))
+static double weighingStore_runAVX2(const int* days, const float* weights, int count, int first, int last) {
+    __m256i lower, upper, day, mask;
+    __m256 weight;
+    __m256d acc;
+    double lanes[4];
+    int i;
+
+    lower = _mm256_set1_epi32(first - 1);
+    upper = _mm256_set1_epi32(last);
+    acc = _mm256_setzero_pd();
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        day = _mm256_loadu_si256((const __m256i*) (days + i));
+        mask = _mm256_and_si256(_mm256_cmpgt_epi32(day, lower), _mm256_cmpgt_epi32(upper, day));
+        weight = _mm256_and_ps(_mm256_loadu_ps(weights + i), _mm256_castsi256_ps(mask));
+
+        // Add in double precision, as the scalar version does
+        acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_castps256_ps128(weight)));
+        acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_extractf128_ps(weight, 1)));
+    }
+
+    _mm256_storeu_pd(lanes, acc);
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + weighingStore_runScalar(days + i, weights + i, count - i, first, last);
+}
+
+// Count of 4 weighings at a time using SSE2
+__attribute__((target("sse2")))
+static int weighingStore_countSSE2(const int* days, const unsigned char* varieties, const int* plots, int count,
+    int first, int last, int variety, bool* marks) {
+    __m128i lower, upper, wanted, zero, day, kind, mask;
+    unsigned int bits;
+    int packed;
+    int matches;
+    int i;
+
+    lower = _mm_set1_epi32(first - 1);
+    upper = _mm_set1_epi32(last);
+    wanted = _mm_set1_epi32(variety);
+    zero = _mm_setzero_si128();
+    matches = 0;
+
+    for (i = 0; i + 4 <= count; i += 4) {
+        day = _mm_loadu_si128((const __m128i*) (days + i));
+
+        // Widen the 4 variety bytes to 32 bits
+        memcpy(&packed, varieties + i, sizeof(int));
+        kind = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+
+        mask = _mm_and_si128(_mm_cmpgt_epi32(day, lower), _mm_cmpgt_epi32(upper, day));
+        mask = _mm_and_si128(mask, _mm_cmpeq_epi32(kind, wanted));
+        bits = (unsigned int) _mm_movemask_ps(_mm_castsi128_ps(mask));
+        if (bits != 0) {
+            matches += __builtin_popcount(bits);
+            if (marks != NULL) {
+                weighingStore_mark(plots + i, bits, marks);
+            }
+        }
+    }
+
+    return matches + weighingStore_countScalar(days + i, varieties + i, plots + i, count - i, first, last, variety, marks);
+}
+
+// Count of 8 weighings at a time using AVX2
+__attribute__((target("avx2")))
+static int weighingStore_countAVX2(const int* days, const unsigned char* varieties, const int* plots, int count,
+    int first, int last, int variety, bool* marks) {
+    __m256i lower, upper, wanted, day, kind, mask;
+    unsigned int bits;
+    int matches;
+    int i;
+
+    lower = _mm256_set1_epi32(first - 1);
+    upper = _mm256_set1_epi32(last);
+    wanted = _mm256_set1_epi32(variety);
+    matches = 0;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        day = _mm256_loadu_si256((const __m256i*) (days + i));
+        kind = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) (varieties + i)));
+
+        mask = _mm256_and_si256(_mm256_cmpgt_epi32(day, lower), _mm256_cmpgt_epi32(upper, day));
+        mask = _mm256_and_si256(mask, _mm256_cmpeq_epi32(kind, wanted));
+        bits = (unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+        if (bits != 0) {
+            matches += __builtin_popcount(bits);
+            if (marks != NULL) {
+                weighingStore_mark(plots + i, bits, marks);
+            }
+        }
+    }
+
+    return matches + weighingStore_countScalar(days + i, varieties + i, plots + i, count - i, first, last, variety, marks);
+}
+
+#endif
+
+// Select the best count implementation for the running CPU
+static tWeighingStoreCountFunc weighingStore_selectCount() {
+#ifdef WEIGHING_STORE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return weighingStore_countAVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return weighingStore_countSSE2;
+    }
+#endif
+    return weighingStore_countScalar;
+}
+
+// Select the best implementation for the running CPU
+static tWeighingStoreFunc weighingStore_select() {
+#ifdef WEIGHING_STORE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return weighingStore_runAVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return weighingStore_runSSE2;
+    }
+#endif
+    return weighingStore_runScalar;
+}
+
+static tWeighingStoreFunc weighingStore_func = NULL;
+static tWeighingStoreCountFunc weighingStore_countFunc = NULL;
+static pthread_once_t weighingStore_once = PTHREAD_ONCE_INIT;
+
+// Select the implementations once, even if several threads aggregate at the same time
+static void weighingStore_setup() {
+    weighingStore_func = weighingStore_select();
+    weighingStore_countFunc = weighingStore_selectCount();
+}
+
+// Initialize an empty store
+void weighingStore_init(tWeighingStore* store) {
+    assert(store != NULL);
+
+    store->days = NULL;
+    store->weights = NULL;
+    store->varieties = NULL;
+    store->plots = NULL;
+    store->count = 0;
+    store->plotList = NULL;
+    store->plotCount = 0;
+    store->slots = NULL;
+    store->slotCapacity = 0;
+    store->valid = false;
+}
+
+// Remove all data from the store
+void weighingStore_free(tWeighingStore* store) {
+    assert(store != NULL);
+
+    arena_free(store->days);
+    arena_free(store->weights);
+    arena_free(store->varieties);
+    arena_free(store->plots);
+    arena_free(store->plotList);
+    arena_free(store->slots);
+    weighingStore_init(store);
+}
+
+// Hash of the symbol of a vineyard code. Each code has a single symbol, so the pointer is hashed
+static unsigned int weighingStore_hash(const char* code) {
+    // Fibonacci hashing, using the high bits of the product
+    return (unsigned int) (((uint64_t) (uintptr_t) code * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+// Store an ordinal in the hash table, that has room for it
+static void weighingStore_slotAdd(tWeighingStore* store, int plot) {
+    unsigned int slot;
+
+    slot = weighingStore_hash(store->plotList[plot].code) & (store->slotCapacity - 1);
+    while (store->slots[slot] != WEIGHING_STORE_EMPTY) {
+        slot = (slot + 1) & (store->slotCapacity - 1);
+    }
+    store->slots[slot] = plot;
+}
+
+// Get the ordinal of a vineyardplot, numbering it if it is not in the store yet
+static int weighingStore_plot(tWeighingStore* store, tWinegrower* winegrower, const char* code) {
+    unsigned int slot;
+    int capacity, i;
+
+    // Find the code in the hash table
+    if (store->slotCapacity > 0) {
+        slot = weighingStore_hash(code) & (store->slotCapacity - 1);
+        while (store->slots[slot] != WEIGHING_STORE_EMPTY) {
+            if (store->plotList[store->slots[slot]].code == code) {
+                return store->slots[slot];
+            }
+            slot = (slot + 1) & (store->slotCapacity - 1);
+        }
+    }
+
+    // Keep the table at most half full, rehashing it into a larger one
+    if (2 * (store->plotCount + 1) > store->slotCapacity) {
+        capacity = (store->slotCapacity == 0) ? WEIGHING_STORE_INITIAL_SLOTS : store->slotCapacity * 2;
+        arena_free(store->slots);
+        store->slots = (int*) arena_malloc(capacity * sizeof(int));
+        assert(store->slots != NULL);
+        store->slotCapacity = capacity;
+        for (i = 0; i < capacity; i++) {
+            store->slots[i] = WEIGHING_STORE_EMPTY;
+        }
+        for (i = 0; i < store->plotCount; i++) {
+            weighingStore_slotAdd(store, i);
+        }
+    }
+
+    store->plotList = (tWeighingStorePlot*) arena_reserve(store->plotList, store->plotCount, sizeof(tWeighingStorePlot));
+    assert(store->plotList != NULL);
+    store->plotList[store->plotCount].winegrower = winegrower;
+    store->plotList[store->plotCount].code = code;
+    weighingStore_slotAdd(store, store->plotCount);
+
+    return store->plotCount++;
+}
+
+// Add a weighing of a vineyardplot of a winegrower at the end of the columns
+void weighingStore_add(tWeighingStore* store, tWinegrower* winegrower, const tVineyardplot* plot, tWeighing weighing) {
+    assert(store != NULL);
+    assert(winegrower != NULL);
+    assert(plot != NULL);
+
+    // The columns have the same count, so they grow at the same time
+    store->days = (tPackedDate*) arena_reserve(store->days, store->count, sizeof(tPackedDate));
+    store->weights = (float*) arena_reserve(store->weights, store->count, sizeof(float));
+    store->varieties = (unsigned char*) arena_reserve(store->varieties, store->count, sizeof(unsigned char));
+    store->plots = (int*) arena_reserve(store->plots, store->count, sizeof(int));
+    assert(store->days != NULL && store->weights != NULL && store->varieties != NULL && store->plots != NULL);
+
+    store->days[store->count] = date_pack(weighing.harvestDay);
+    store->weights[store->count] = weighing.weight;
+    store->varieties[store->count] = (unsigned char) plot->grapeVariety;
+    store->plots[store->count] = weighingStore_plot(store, winegrower, plot->code);
+    store->count++;
+}
+
+// Store the weighings of all the vineyardplots of a list of winegrowers, removing previous data
+void weighingStore_build(tWeighingStore* store, tWinegrowerList list) {
+    tWinegrowerNode* pNode;
+    tVineyardplot* plot;
+    tWeighingNode* pWeighing;
+    int i;
+
+    assert(store != NULL);
+
+    weighingStore_free(store);
+    for (pNode = list.first; pNode != NULL; pNode = pNode->next) {
+        for (i = 0; i < pNode->winegrower.vineyardplots.count; i++) {
+            plot = &(pNode->winegrower.vineyardplots.elems[i]);
+            for (pWeighing = plot->weights.first; pWeighing != NULL; pWeighing = pWeighing->next) {
+                weighingStore_add(store, &(pNode->winegrower), plot, pWeighing->elem);
+            }
+        }
+    }
+    store->valid = true;
+}
+
+// Get the total weight of the weighings of a given year
+double weighingStore_sumByYear(const tWeighingStore* store, int year) {
+    assert(store != NULL);
+
+    pthread_once(&weighingStore_once, weighingStore_setup);
+
+    return weighingStore_func(store->days, store->weights, store->count, year * DATE_PACK_YEAR, (year + 1) * DATE_PACK_YEAR);
+}
+
+// Get the number of weighings of a given year in vineyardplots of a grape variety
+int weighingStore_countByYear(const tWeighingStore* store, int year, tGrapeVariety grapeVariety, bool* plots) {
+    assert(store != NULL);
+
+    pthread_once(&weighingStore_once, weighingStore_setup);
+
+    return weighingStore_countFunc(store->days, store->varieties, store->plots, store->count, year * DATE_PACK_YEAR,
+        (year + 1) * DATE_PACK_YEAR, (int) grapeVariety, plots);
+}
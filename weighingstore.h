@@ -0,0 +1,58 @@
+#ifndef __WEIGHINGSTORE_H__
+#define __WEIGHINGSTORE_H__
+
+#include <stdbool.h>
+#include "winegrower.h"
+
+// Initial number of slots of the hash table from vineyard code to plot ordinal. It is always a power of two
+#define WEIGHING_STORE_INITIAL_SLOTS 64
+
+// Value of the free slots of the hash table of a store
+#define WEIGHING_STORE_EMPTY -1
+
+// Vineyardplot of a store: the winegrower that owns it and its code
+typedef struct _tWeighingStorePlot {
+    tWinegrower* winegrower;
+    const char* code;
+} tWeighingStorePlot;
+
+// Weighings of a group of vineyardplots stored by columns, so aggregations only read the columns they need:
+// packed harvest day (date_pack), weight, grape variety and ordinal of the vineyardplot in the group.
+// Vineyardplots are numbered as they join the store, and an open addressing hash table on the code symbol
+// gives the ordinal of a code. Columns and tables are vectors that only keep their count
+typedef struct _tWeighingStore {
+    tPackedDate* days;
+    float* weights;
+    unsigned char* varieties;
+    int* plots;
+    int count;
+    tWeighingStorePlot* plotList;
+    int plotCount;
+    int* slots;
+    int slotCapacity;
+    bool valid;
+} tWeighingStore;
+
+// Initialize an empty store, not valid until it is built
+void weighingStore_init(tWeighingStore* store);
+
+// Remove all data from the store
+void weighingStore_free(tWeighingStore* store);
+
+// Add a weighing of a vineyardplot of a winegrower at the end of the columns. The variety column keeps the grape
+// variety of the vineyardplot
+void weighingStore_add(tWeighingStore* store, tWinegrower* winegrower, const tVineyardplot* plot, tWeighing weighing);
+
+// Store the weighings of all the vineyardplots of a list of winegrowers, removing previous data.
+// Vineyardplots are numbered in the order of the list
+void weighingStore_build(tWeighingStore* store, tWinegrowerList list);
+
+// Get the total weight of the weighings of a given year, using AVX2 or SSE2 if the CPU has them
+double weighingStore_sumByYear(const tWeighingStore* store, int year);
+
+// Get the number of weighings of a given year in vineyardplots of a grape variety, using AVX2 or SSE2 if the CPU
+// has them. If plots is not NULL, the positions of the ordinals of the vineyardplots with those weighings are set
+// to true
+int weighingStore_countByYear(const tWeighingStore* store, int year, tGrapeVariety grapeVariety, bool* plots);
+
+#endif
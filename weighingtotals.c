@@ -0,0 +1,144 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "weighingtotals.h"
+#include "arena.h"
+
+// Initialize the totals, not valid until they are built
+void weighingTotals_init(tWeighingTotals* totals) {
+    assert(totals != NULL);
+
+    totals->years = NULL;
+    totals->totals = NULL;
+    totals->count = 0;
+    totals->capacity = 0;
+    totals->valid = false;
+}
+
+// Remove all data from the totals
+void weighingTotals_free(tWeighingTotals* totals) {
+    assert(totals != NULL);
+
+    arena_free(totals->years);
+    arena_free(totals->totals);
+    weighingTotals_init(totals);
+}
+
+// Hash of a year
+static unsigned int weighingTotals_hash(int year) {
+    // Fibonacci hashing, using the high bits of the product
+    return (unsigned int) (((uint64_t) (unsigned int) year * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+// Slot of a year in the hash table, or the free slot where it goes
+static unsigned int weighingTotals_slot(const tWeighingTotals* totals, int year) {
+    unsigned int slot;
+
+    slot = weighingTotals_hash(year) & (totals->capacity - 1);
+    while (totals->years[slot] != WEIGHING_TOTALS_EMPTY && totals->years[slot] != year) {
+        slot = (slot + 1) & (totals->capacity - 1);
+    }
+
+    return slot;
+}
+
+// Rehash the totals into a table of the given capacity
+static void weighingTotals_resize(tWeighingTotals* totals, int capacity) {
+    int *years;
+    double *values;
+    unsigned int slot;
+    int oldCapacity, i;
+
+    years = totals->years;
+    values = totals->totals;
+    oldCapacity = totals->capacity;
+
+    totals->years = (int*) arena_malloc(capacity * sizeof(int));
+    totals->totals = (double*) arena_malloc(capacity * sizeof(double));
+    assert(totals->years != NULL && totals->totals != NULL);
+    totals->capacity = capacity;
+    for (i = 0; i < capacity; i++) {
+        totals->years[i] = WEIGHING_TOTALS_EMPTY;
+    }
+
+    for (i = 0; i < oldCapacity; i++) {
+        if (years[i] != WEIGHING_TOTALS_EMPTY) {
+            slot = weighingTotals_slot(totals, years[i]);
+            totals->years[slot] = years[i];
+            totals->totals[slot] = values[i];
+        }
+    }
+    arena_free(years);
+    arena_free(values);
+}
+
+// Add a weight to the total of a year, adding the year if it is not in the totals yet
+static void weighingTotals_addYear(tWeighingTotals* totals, int year, double weight) {
+    unsigned int slot;
+
+    assert(year != WEIGHING_TOTALS_EMPTY);
+
+    // Keep the table at most half full
+    if (2 * (totals->count + 1) > totals->capacity) {
+        weighingTotals_resize(totals, (totals->capacity == 0) ? WEIGHING_TOTALS_INITIAL_SLOTS : totals->capacity * 2);
+    }
+
+    slot = weighingTotals_slot(totals, year);
+    if (totals->years[slot] == WEIGHING_TOTALS_EMPTY) {
+        totals->years[slot] = year;
+        totals->totals[slot] = 0.0;
+        totals->count++;
+    }
+    totals->totals[slot] += weight;
+}
+
+// Compute the totals of the weighings of all the vineyardplots of a list of winegrowers in a single walk
+void weighingTotals_build(tWeighingTotals* totals, tWinegrowerList list) {
+    tWinegrowerNode* pNode;
+    tWeighingNode* pWeighing;
+    int i;
+
+    assert(totals != NULL);
+
+    weighingTotals_free(totals);
+    for (pNode = list.first; pNode != NULL; pNode = pNode->next) {
+        for (i = 0; i < pNode->winegrower.vineyardplots.count; i++) {
+            for (pWeighing = pNode->winegrower.vineyardplots.elems[i].weights.first; pWeighing != NULL; pWeighing = pWeighing->next) {
+                // Added in the order of the lists, so each total is the same as a walk for its year gives
+                weighingTotals_addYear(totals, pWeighing->elem.harvestDay.year, pWeighing->elem.weight);
+            }
+        }
+    }
+    totals->valid = true;
+}
+
+// Add a weight to the total of its year, if the totals are valid
+void weighingTotals_add(tWeighingTotals* totals, int year, double weight) {
+    assert(totals != NULL);
+
+    if (totals->valid) {
+        weighingTotals_addYear(totals, year, weight);
+    }
+}
+
+// Get the total weight of a year. Return false if the totals are not valid
+bool weighingTotals_find(const tWeighingTotals* totals, int year, double* total) {
+    unsigned int slot;
+
+    assert(totals != NULL);
+    assert(total != NULL);
+
+    if (!totals->valid) {
+        return false;
+    }
+
+    *total = 0.0;
+    if (totals->count > 0 && year != WEIGHING_TOTALS_EMPTY) {
+        slot = weighingTotals_slot(totals, year);
+        if (totals->years[slot] == year) {
+            *total = totals->totals[slot];
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef __WEIGHINGTOTALS_H__
+#define __WEIGHINGTOTALS_H__
+
+#include <limits.h>
+#include <stdbool.h>
+#include "winegrower.h"
+
+// Initial number of slots of the totals. It is always a power of two
+#define WEIGHING_TOTALS_INITIAL_SLOTS 16
+
+// Year of the free slots of the totals
+#define WEIGHING_TOTALS_EMPTY INT_MIN
+
+// Total weight of the weighings of a group of vineyardplots for each year, in an open addressing hash table
+// from year to total that grows with the years. The totals are only valid from weighingTotals_build on, and
+// the owner of the group keeps them up to date with the weighings it adds or removes
+typedef struct _tWeighingTotals {
+    int* years;
+    double* totals;
+    int count;
+    int capacity;
+    bool valid;
+} tWeighingTotals;
+
+// Initialize the totals, not valid until they are built
+void weighingTotals_init(tWeighingTotals* totals);
+
+// Remove all data from the totals, leaving them not valid
+void weighingTotals_free(tWeighingTotals* totals);
+
+// Compute the totals of the weighings of all the vineyardplots of a list of winegrowers in a single walk,
+// removing previous data
+void weighingTotals_build(tWeighingTotals* totals, tWinegrowerList list);
+
+// Add a weight to the total of its year, if the totals are valid. The weights are added in the order of the
+// changes, so a total can differ from a walk of the lists in the last bits
+void weighingTotals_add(tWeighingTotals* totals, int year, double weight);
+
+// Get the total weight of a year. Return false if the totals are not valid
+bool weighingTotals_find(const tWeighingTotals* totals, int year, double* total);
+
+#endif
@@ -8,6 +8,9 @@
 #include "winegrower.h"
 #include "vineyardplot.h"
 #include "grapevariety.h"
+#include "symbol.h"
+#include "arena.h"
+#include "nodepool.h"
 
 // Initialize the winegrowers data
 tApiError winegrower_init(tWinegrower* winegrower,const char * id, const char * document, tDate registrationDate) {
@@ -16,14 +19,15 @@ tApiError winegrower_init(tWinegrower* winegrower,const char * id, const char *
     assert(id != NULL);
     assert(document != NULL);
     
+    // The id is a symbol, shared by all the copies of the winegrower
+    winegrower->id = (char*) symbol_intern(id);
+
     // Allocate the memory for the string fields, using the length of the provided text plus 1 space
     //for the "end of string" char '\0'. To allocate memory we use the malloc command.
-    winegrower->id = (char*)malloc((strlen(id) + 1) * sizeof(char));
-
-    winegrower->document = (char*)malloc((strlen(document) + 1) * sizeof(char));
+    winegrower->document = (char*)arena_malloc((strlen(document) + 1) * sizeof(char));
 
     // Check that memory has been allocated for all fields. Pointer must be different from NULL.
-    if (winegrower->id == NULL || winegrower->document == NULL) {
+    if (winegrower->document == NULL) {
         // Some of the fields have a NULL value, what means that we found some problem allocating the memory
         return E_MEMORY_ERROR;
     }
@@ -31,7 +35,6 @@ tApiError winegrower_init(tWinegrower* winegrower,const char * id, const char *
     // Once the memory is allocated, copy the data.
     
      // Set the data
-    strcpy(winegrower->id, id);
     strcpy(winegrower->document, document);
     winegrower->registrationDate.day = registrationDate.day;
     winegrower->registrationDate.month = registrationDate.month;
@@ -57,14 +60,11 @@ void winegrower_cpy(tWinegrower* destination, tWinegrower source){
 void winegrower_free(tWinegrower* winegrower) {
     assert(winegrower != NULL);
     
-    // Release used memory
-    if (winegrower->id != NULL) {
-        free(winegrower->id);
-        winegrower->id = NULL;
-    }
+    // Release used memory. The id is a symbol, it is not released
+    winegrower->id = NULL;
     
     if (winegrower->document != NULL) {
-        free(winegrower->document);
+        arena_free(winegrower->document);
         winegrower->document = NULL;
     }
         
@@ -130,6 +130,13 @@ void winegrowerList_init(tWinegrowerList* list) {
 tWinegrower* winegrowerList_containsVineyardplot(tWinegrowerList list, const char* code){
    tWinegrower* pWinegrower = NULL;
    tWinegrowerNode *pNode = NULL;
+   const char* symbol;
+    
+    // Codes of the vineyardplots are symbols. If the code has no symbol, no vineyardplot has it
+    symbol = symbol_find(code);
+    if (symbol == NULL) {
+        return NULL;
+    }
         
     // Point the first element
     pNode = list.first;
@@ -140,7 +147,7 @@ tWinegrower* winegrowerList_containsVineyardplot(tWinegrowerList list, const cha
     
             for(int i=0; i < pNode->winegrower.vineyardplots.count; i++) {
                 // Compare current with given code
-                if(strcmp(pNode->winegrower.vineyardplots.elems[i].code, code) == 0) {
+                if(pNode->winegrower.vineyardplots.elems[i].code == symbol) {
                     pWinegrower = &pNode->winegrower;
                 }
             }
@@ -163,7 +170,7 @@ void winegrowerList_insert(tWinegrowerList* list, tWinegrower winegrower){
     
     // If the list is empty add the node as first position
     if (list->count == 0) {
-        list->first = (tWinegrowerNode*) malloc(sizeof(tWinegrowerNode));
+        list->first = nodePool_newWinegrowerNode();
         list->first->next = NULL;
         winegrower_cpy(&(list->first->winegrower), winegrower);
     } else {    
@@ -179,12 +186,12 @@ void winegrowerList_insert(tWinegrowerList* list, tWinegrower winegrower){
                 
         if (pNode == pPrev) {
             // Insert as first element
-            list->first = (tWinegrowerNode*) malloc(sizeof(tWinegrowerNode));
+            list->first = nodePool_newWinegrowerNode();
             list->first->next = pNode;
             winegrower_cpy(&(list->first->winegrower), winegrower);            
         } else {
             // Insert after pPrev
-            pPrev->next = (tWinegrowerNode*) malloc(sizeof(tWinegrowerNode));        
+            pPrev->next = nodePool_newWinegrowerNode();        
             winegrower_cpy(&(pPrev->next->winegrower), winegrower);
             pPrev->next->next = pNode;            
         }
@@ -208,23 +215,45 @@ tWinegrowerList winegrowerList_orderByDateAndId(tWinegrowerList* list){
     tWinegrowerNode *pActualAux = NULL;
     tWinegrowerNode *pNextAux = NULL;
     tWinegrower wgTemp;
+    tPackedDate* dates;
+    tPackedDate dateTemp;
+    int cmp, count, i, j;
     
     // Create a copy of data
     winegrowerList_cpy(&listSorted,*list);
     
+    // The registration date of each node is packed once, in the position of the node in the list
+    count = 0;
+    for (pActualAux = listSorted.first; pActualAux != NULL; pActualAux = pActualAux->next) {
+        count++;
+    }
+    dates = (tPackedDate*) malloc((count > 0 ? count : 1) * sizeof(tPackedDate));
+    if (dates == NULL) {
+        winegrowerList_free(&listSorted);
+        listSorted.count = -1;
+        return listSorted;
+    }
+    i = 0;
+    for (pActualAux = listSorted.first; pActualAux != NULL; pActualAux = pActualAux->next) {
+        dates[i++] = date_pack(pActualAux->winegrower.registrationDate);
+    }
+    
     //Assign the first node of the copied data to the actual auxiliar node
     pActualAux = listSorted.first;
+    i = 0;
     
     //While the actual auxiliar node is not null
     while (pActualAux != NULL){
         //Assign the next node of the copied data from the actual auxiliar to the next auxiliar node
         pNextAux = pActualAux ->next;
+        j = i + 1;
         //While the next auxilair node is not null (is not the last one)
         while (pNextAux != NULL){
-            //Compare the dates between the actual auxiliar node and the next auxiliar one in case they are different
-            if (date_cmp(pActualAux->winegrower.registrationDate, pNextAux->winegrower.registrationDate)>0 ||
+            //Compare the packed dates between the actual auxiliar node and the next auxiliar one in case they are different
+            cmp = date_cmpPacked(dates[i], dates[j]);
+            if (cmp>0 ||
             //Or, if the dates are equal, compare the wg ids between the actual auxiliar node and the next auxiliar node
-                (date_cmp(pActualAux->winegrower.registrationDate, pNextAux->winegrower.registrationDate)==0 &&
+                (cmp==0 &&
                 strcmp(pActualAux->winegrower.id, pNextAux->winegrower.id)>0)) {
                 //If one of the previous cases match, we assign to a temporal variable the winegrower from the actual auxiliar node
                 wgTemp = pActualAux->winegrower;
@@ -232,13 +261,20 @@ tWinegrowerList winegrowerList_orderByDateAndId(tWinegrowerList* list){
                 pActualAux->winegrower = pNextAux->winegrower;
                 //Assign to the temporal variable the next node since it'll be larger than the previous
                 pNextAux->winegrower=wgTemp;
+                //The packed dates are exchanged with the winegrowers
+                dateTemp = dates[i];
+                dates[i] = dates[j];
+                dates[j] = dateTemp;
             }
             //Prepare the next auxiliar node to the next iteration
             pNextAux = pNextAux ->next;
+            j++;
         }
         //Prepare the actual auxiliar node to the next iteration
         pActualAux =pActualAux->next;
+        i++;
     }
+    free(dates);
 
     //Return the list sorted
     return listSorted;
@@ -247,13 +283,20 @@ tWinegrowerList winegrowerList_orderByDateAndId(tWinegrowerList* list){
 tWinegrower* winegrowerList_find(tWinegrowerList list, const char* id)
 {
     tWinegrowerNode *pNode = NULL;
+    const char* symbol;
     
     assert(id != NULL);
     
+    // Ids of the winegrowers are symbols. If the id has no symbol, no winegrower has it
+    symbol = symbol_find(id);
+    if (symbol == NULL) {
+        return NULL;
+    }
+    
     pNode = list.first;
     
     while (pNode != NULL) {
-        if (strcmp(pNode->winegrower.id, id) == 0) {
+        if (pNode->winegrower.id == symbol) {
             return &(pNode->winegrower);
         }
         
@@ -263,6 +306,36 @@ tWinegrower* winegrowerList_find(tWinegrowerList list, const char* id)
     return NULL;
 }
 
+// Add a winegrower to a list that is being built from another list, skipping repeated ids.
+// Winegrowers that arrive in id order are linked after the last node without searching the list
+static void winegrowerList_addUnique(tWinegrowerList* list, tWinegrowerNode** pLast, tWinegrower winegrower) {
+    tWinegrowerNode* pNode;
+    int cmp;
+    
+    if (*pLast == NULL) {
+        cmp = 1;
+    } else {
+        cmp = (winegrower.id == (*pLast)->winegrower.id) ? 0 : strcmp(winegrower.id, (*pLast)->winegrower.id);
+    }
+    if (cmp > 0) {
+        // Link after the last node
+        pNode = nodePool_newWinegrowerNode();
+        assert(pNode != NULL);
+        winegrower_cpy(&(pNode->winegrower), winegrower);
+        pNode->next = NULL;
+        if (*pLast == NULL) {
+            list->first = pNode;
+        } else {
+            (*pLast)->next = pNode;
+        }
+        *pLast = pNode;
+        list->count++;
+    } else if (cmp < 0 && winegrowerList_find(*list, winegrower.id) == NULL) {
+        // The source list is not sorted by id
+        winegrowerList_insert(list, winegrower);
+    }
+}
+
 // Find winegrowers that has a vineyard with a specific variety of grape
 tWinegrowerList winegrowerList_findByGrapevariety(tWinegrowerList winegrowerList, tGrapeVariety grapeVariety) {
     // PR3 EX 2b
@@ -271,7 +344,7 @@ tWinegrowerList winegrowerList_findByGrapevariety(tWinegrowerList winegrowerList
     // Output a new list of winegrowers orderd by document id that has a vineyardplot with the given variety of grape
     
     tWinegrowerList newList;
-    tWinegrower* foundWinegrower;
+    tWinegrowerNode* pLast = NULL;
     int i = 0;
     
     // Initialize to an empty list
@@ -286,13 +359,9 @@ tWinegrowerList winegrowerList_findByGrapevariety(tWinegrowerList winegrowerList
         for (i = 0; i< pNode->winegrower.vineyardplots.count; i++){
             //For the actual position of the iteration, if we find a match in the grapevariety between the input list and the input grapevariety
             if (pNode->winegrower.vineyardplots.elems[i].grapeVariety== grapeVariety){
-                //Find the pointer to the wg
-                foundWinegrower = winegrowerList_find(newList, pNode->winegrower.id);
-                //In case the pointer is not null because it exists or is not in the new list yet
-                if (foundWinegrower == NULL) {
-                    //Add the wg list of the grapevariety from the input
-                    winegrowerList_insert(&newList, pNode->winegrower);
-                }
+                //Add the wg to the new list if it is not there yet, and go to the next wg
+                winegrowerList_addUnique(&newList, &pLast, pNode->winegrower);
+                break;
             }
         }
         //Iterate to the next node
@@ -310,8 +379,9 @@ tWinegrowerList winegrowerList_findByWeighingYearAndGrapevariety(tWinegrowerList
     // Input a variety of grape
     // Output a new list of winegrowers orderd by document id that has a vineyardplot that had weighing on the given year and variety of grape
     tWinegrowerList newList;
-    tWinegrower* foundWinegrower;
+    tWinegrowerNode* pLast = NULL;
     tWeighingNode* weighNode;
+    bool found;
     
     int i = 0;
     
@@ -323,23 +393,20 @@ tWinegrowerList winegrowerList_findByWeighingYearAndGrapevariety(tWinegrowerList
 
     //While the auxiliar node is not null (in the first iteration will be in case if the list is not empty)
     while (pNode != NULL ){
+        found = false;
         //Iterate all the vineyardplots
-        for (i = 0; i< pNode->winegrower.vineyardplots.count ; i++){
+        for (i = 0; i< pNode->winegrower.vineyardplots.count && !found; i++){
             //For the actual position of the iteration, if we find a match in the grapevariety between the input list and the input grapevariety
             if (pNode->winegrower.vineyardplots.elems[i].grapeVariety== grapeVariety){
                 //Assign to an auxiliar weighing node the first node of weights
                 weighNode = pNode->winegrower.vineyardplots.elems[i].weights.first;
                 //While the auxiliar weighing node is not null (or in the first iteration has some weights registered)
-                while (weighNode !=NULL ){
+                while (weighNode !=NULL && !found){
                     //Check if for the auxiliar weighing node the harvest year is equal to the input
                     if (weighNode->elem.harvestDay.year == year) {
-                        //Find the pointer to the wg for the input
-                        foundWinegrower = winegrowerList_find(newList, pNode->winegrower.id);
-                        //In case the pointer is not null because it exists or is not in the new list yet
-                        if (foundWinegrower == NULL) {
-                            //Add the wg list of the grapevariety from the input
-                            winegrowerList_insert(&newList, pNode->winegrower);
-                        }
+                        //Add the wg to the new list if it is not there yet, and go to the next wg
+                        winegrowerList_addUnique(&newList, &pLast, pNode->winegrower);
+                        found = true;
                     }
                      //Iterate to the next weighing node
                     weighNode = weighNode->next;
@@ -369,7 +436,7 @@ void winegrowerList_free(tWinegrowerList* list) {
         pNode = pNode->next;        
         // Remove previous node
         winegrower_free(&(pAux->winegrower));
-        free(pAux);
+        nodePool_freeWinegrowerNode(pAux);
     }
     
     // Initialize to an empty list
@@ -429,7 +496,7 @@ void winegrowerList_cpy(tWinegrowerList* destination, tWinegrowerList source){
     //While the aux node is null (or in the first iteration the struct is not empty)
     while (auxSource !=NULL){
         //Assign memory to the auxdestination node
-        auxDestination = (tWinegrowerNode*) malloc (sizeof(tWinegrowerNode));
+        auxDestination = nodePool_newWinegrowerNode();
         //Initialize winegrower list
         winegrower_init(&auxDestination->winegrower, auxSource->winegrower.id, auxSource->winegrower.document, auxSource->winegrower.registrationDate );
         //Remove data of the auxdestination next node
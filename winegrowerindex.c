@@ -0,0 +1,439 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include "winegrowerindex.h"
+#include "symbol.h"
+#include "arena.h"
+#include "nodepool.h"
+
+// Hash of a winegrower id (FNV-1a)
+static uint32_t winegrowerIndex_hash(const char* id) {
+    uint32_t hash = 2166136261u;
+
+    while (*id != '\0') {
+        hash ^= (unsigned char) *id;
+        hash *= 16777619u;
+        id++;
+    }
+
+    return hash;
+}
+
+// Store a node in the first free slot of its probe sequence
+static void winegrowerIndex_place(tWinegrowerNode** slots, int capacity, tWinegrowerNode* node) {
+    uint32_t pos;
+
+    pos = winegrowerIndex_hash(node->winegrower.id) & (capacity - 1);
+    while (slots[pos] != NULL) {
+        pos = (pos + 1) & (capacity - 1);
+    }
+    slots[pos] = node;
+}
+
+// Double the number of slots, placing again all the nodes
+static void winegrowerIndex_grow(tWinegrowerIndex* index) {
+    tWinegrowerNode** slots;
+    int capacity, i;
+
+    capacity = (index->capacity == 0) ? WINEGROWER_INDEX_INITIAL_CAPACITY : index->capacity * 2;
+    slots = (tWinegrowerNode**) arena_calloc(capacity, sizeof(tWinegrowerNode*));
+    assert(slots != NULL);
+
+    for (i = 0; i < index->capacity; i++) {
+        if (index->slots[i] != NULL) {
+            winegrowerIndex_place(slots, capacity, index->slots[i]);
+        }
+    }
+
+    if (index->slots != NULL) {
+        arena_free(index->slots);
+    }
+    index->slots = slots;
+    index->capacity = capacity;
+}
+
+// Create an empty node of the tree, aligned to a cache line
+static tWinegrowerTreeNode* winegrowerTree_new(bool leaf) {
+    tWinegrowerTreeNode* node;
+
+    node = (tWinegrowerTreeNode*) arena_mallocAligned(WINEGROWER_TREE_ALIGNMENT, sizeof(tWinegrowerTreeNode));
+    assert(node != NULL);
+    node->count = 0;
+    node->leaf = leaf;
+
+    return node;
+}
+
+// Release a subtree
+static void winegrowerTree_free(tWinegrowerTreeNode* node) {
+    int i;
+
+    if (node == NULL) {
+        return;
+    }
+    if (!node->leaf) {
+        for (i = 0; i < node->count; i++) {
+            winegrowerTree_free(node->children[i]);
+        }
+    }
+    arena_free(node);
+}
+
+// Key of an id in the tree: its first bytes, the first one in the highest byte, and zeros after its end.
+// Ids of up to WINEGROWER_TREE_KEY_SIZE bytes have different keys, sorted as the ids
+static uint64_t winegrowerTree_key(const char* id) {
+    uint64_t key;
+    int i;
+
+    key = 0;
+    for (i = 0; i < WINEGROWER_TREE_KEY_SIZE; i++) {
+        key <<= 8;
+        if (*id != '\0') {
+            key |= (unsigned char) *id;
+            id++;
+        }
+    }
+
+    return key;
+}
+
+// Number of keys of a tree node lower than the given one
+static int winegrowerTree_lower(const tWinegrowerTreeNode* node, uint64_t key) {
+    int first, last, middle;
+
+    // Binary search in the sorted keys
+    first = 0;
+    last = node->count;
+    while (first < last) {
+        middle = (first + last) / 2;
+        if (node->keys[middle] < key) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    return first;
+}
+
+// Insert a key and its item, a list node or a child, in a position of a tree node. If the node is full,
+// the upper half of the entries moves to a new node, that is returned
+static tWinegrowerTreeNode* winegrowerTree_place(tWinegrowerTreeNode* node, int pos, uint64_t key, void* item) {
+    uint64_t keys[WINEGROWER_TREE_ORDER + 1];
+    void* items[WINEGROWER_TREE_ORDER + 1];
+    tWinegrowerTreeNode* sibling;
+    int i, count;
+
+    if (node->count < WINEGROWER_TREE_ORDER) {
+        // Make room for the entry in its position
+        for (i = node->count; i > pos; i--) {
+            node->keys[i] = node->keys[i - 1];
+            node->entries[i] = node->entries[i - 1];
+        }
+        node->keys[pos] = key;
+        node->entries[pos] = (tWinegrowerNode*) item;
+        node->count++;
+        return NULL;
+    }
+
+    // The node has no room for one more entry, so the entries are split out of it
+    count = 0;
+    for (i = 0; i <= WINEGROWER_TREE_ORDER; i++) {
+        if (i == pos) {
+            keys[i] = key;
+            items[i] = item;
+        } else {
+            keys[i] = node->keys[count];
+            items[i] = node->entries[count];
+            count++;
+        }
+    }
+
+    sibling = winegrowerTree_new(node->leaf);
+    sibling->count = (WINEGROWER_TREE_ORDER + 1) / 2;
+    node->count = WINEGROWER_TREE_ORDER + 1 - sibling->count;
+    for (i = 0; i < node->count; i++) {
+        node->keys[i] = keys[i];
+        node->entries[i] = (tWinegrowerNode*) items[i];
+    }
+    for (i = 0; i < sibling->count; i++) {
+        sibling->keys[i] = keys[node->count + i];
+        sibling->entries[i] = (tWinegrowerNode*) items[node->count + i];
+    }
+
+    return sibling;
+}
+
+// Insert a list node with the given key in a subtree. If the subtree root is split, return the new right sibling
+static tWinegrowerTreeNode* winegrowerTree_insert(tWinegrowerTreeNode* node, uint64_t key, tWinegrowerNode* entry) {
+    tWinegrowerTreeNode* child;
+    int pos;
+
+    pos = winegrowerTree_lower(node, key);
+    if (node->leaf) {
+        return winegrowerTree_place(node, pos, key, entry);
+    }
+
+    // Go down through the last child with a lower key, or the first one
+    if (pos > 0) {
+        pos--;
+    }
+    child = winegrowerTree_insert(node->children[pos], key, entry);
+    node->keys[pos] = node->children[pos]->keys[0];
+
+    // Add the new child after the one that was split
+    if (child == NULL) {
+        return NULL;
+    }
+    return winegrowerTree_place(node, pos + 1, child->keys[0], child);
+}
+
+// Add a list node to the tree
+static void winegrowerTree_add(tWinegrowerIndex* index, tWinegrowerNode* entry) {
+    tWinegrowerTreeNode *sibling, *root;
+
+    // Longer ids would share their keys, so the tree is no longer kept
+    if (index->longIds || strlen(entry->winegrower.id) > WINEGROWER_TREE_KEY_SIZE) {
+        winegrowerTree_free(index->root);
+        index->root = NULL;
+        index->longIds = true;
+        return;
+    }
+
+    if (index->root == NULL) {
+        index->root = winegrowerTree_new(true);
+    }
+
+    sibling = winegrowerTree_insert(index->root, winegrowerTree_key(entry->winegrower.id), entry);
+    if (sibling != NULL) {
+        // The root was split. The tree grows one level
+        root = winegrowerTree_new(false);
+        root->keys[0] = index->root->keys[0];
+        root->children[0] = index->root;
+        root->keys[1] = sibling->keys[0];
+        root->children[1] = sibling;
+        root->count = 2;
+        index->root = root;
+    }
+}
+
+// Initialize an empty index
+void winegrowerIndex_init(tWinegrowerIndex* index) {
+    assert(index != NULL);
+
+    index->slots = NULL;
+    index->capacity = 0;
+    index->count = 0;
+    index->root = NULL;
+    index->longIds = false;
+}
+
+// Remove all data from the index
+void winegrowerIndex_free(tWinegrowerIndex* index) {
+    assert(index != NULL);
+
+    if (index->slots != NULL) {
+        arena_free(index->slots);
+    }
+    winegrowerTree_free(index->root);
+    winegrowerIndex_init(index);
+}
+
+// Add a node of the list to the index
+void winegrowerIndex_add(tWinegrowerIndex* index, tWinegrowerNode* node) {
+    assert(index != NULL);
+    assert(node != NULL);
+
+    // Keep the load factor under 1/2 so probe sequences stay short
+    if (2 * (index->count + 1) > index->capacity) {
+        winegrowerIndex_grow(index);
+    }
+    winegrowerIndex_place(index->slots, index->capacity, node);
+    winegrowerTree_add(index, node);
+    index->count++;
+}
+
+// Index all the nodes of a list, removing previous data
+void winegrowerIndex_build(tWinegrowerIndex* index, tWinegrowerList list) {
+    tWinegrowerNode* pNode;
+
+    assert(index != NULL);
+
+    winegrowerIndex_free(index);
+    for (pNode = list.first; pNode != NULL; pNode = pNode->next) {
+        winegrowerIndex_add(index, pNode);
+    }
+}
+
+// Find a winegrower of the list by id
+tWinegrower* winegrowerIndex_find(const tWinegrowerIndex* index, const tWinegrowerList* list, const char* id) {
+    const char* symbol;
+    uint32_t pos;
+
+    assert(index != NULL);
+    assert(list != NULL);
+    assert(id != NULL);
+
+    // The list was modified without updating the index
+    if (index->count != list->count) {
+        return winegrowerList_find(*list, id);
+    }
+    // Ids of the winegrowers are symbols. If the id has no symbol, no winegrower has it
+    if (index->count == 0 || (symbol = symbol_find(id)) == NULL) {
+        return NULL;
+    }
+
+    pos = winegrowerIndex_hash(symbol) & (index->capacity - 1);
+    while (index->slots[pos] != NULL) {
+        if (index->slots[pos]->winegrower.id == symbol) {
+            return &(index->slots[pos]->winegrower);
+        }
+        pos = (pos + 1) & (index->capacity - 1);
+    }
+
+    return NULL;
+}
+
+// Find the last node of the list with an id lower than the given one
+tWinegrowerNode* winegrowerIndex_predecessor(const tWinegrowerIndex* index, const char* id) {
+    tWinegrowerTreeNode* node;
+    uint64_t key;
+    int pos;
+
+    assert(index != NULL);
+    assert(id != NULL);
+    assert(!index->longIds && strlen(id) <= WINEGROWER_TREE_KEY_SIZE);
+
+    node = index->root;
+    if (node == NULL) {
+        return NULL;
+    }
+
+    // Go down through the last child with a lower key
+    key = winegrowerTree_key(id);
+    while (!node->leaf) {
+        pos = winegrowerTree_lower(node, key);
+        if (pos == 0) {
+            // All the ids of the tree are greater or equal
+            return NULL;
+        }
+        node = node->children[pos - 1];
+    }
+
+    pos = winegrowerTree_lower(node, key);
+    return (pos == 0) ? NULL : node->entries[pos - 1];
+}
+
+// Link a new node to the list in the position of the given id. The winegrower of the node is not set
+static tWinegrowerNode* winegrowerIndex_link(tWinegrowerIndex* index, tWinegrowerList* list, const char* id) {
+    tWinegrowerNode *pNode, *pPrev, *pNew;
+
+    // The list was modified without updating the index
+    if (index->count != list->count) {
+        winegrowerIndex_build(index, *list);
+    }
+
+    // Get the insertion point from the tree instead of walking the list. Long ids have no exact key, so
+    // they are placed walking the list
+    if (index->longIds || strlen(id) > WINEGROWER_TREE_KEY_SIZE) {
+        pPrev = NULL;
+        pNode = list->first;
+        while (pNode != NULL && strcmp(pNode->winegrower.id, id) < 0) {
+            pPrev = pNode;
+            pNode = pNode->next;
+        }
+    } else {
+        pPrev = winegrowerIndex_predecessor(index, id);
+        pNode = (pPrev == NULL) ? list->first : pPrev->next;
+    }
+
+    pNew = nodePool_newWinegrowerNode();
+    assert(pNew != NULL);
+    pNew->next = pNode;
+    if (pPrev == NULL) {
+        list->first = pNew;
+    } else {
+        pPrev->next = pNew;
+    }
+    list->count++;
+
+    return pNew;
+}
+
+// Insert a copy of a winegrower in the list sorted by id and add it to the index
+tWinegrower* winegrowerIndex_insert(tWinegrowerIndex* index, tWinegrowerList* list, tWinegrower winegrower) {
+    tWinegrowerNode* pNew;
+
+    assert(index != NULL);
+    assert(list != NULL);
+
+    pNew = winegrowerIndex_link(index, list, winegrower.id);
+    winegrower_cpy(&(pNew->winegrower), winegrower);
+
+    // The hash table reads the id of the node, so it is added once the winegrower is set
+    winegrowerIndex_add(index, pNew);
+
+    return &(pNew->winegrower);
+}
+
+// Check if the document, the vineyardplots and the weighings of a winegrower are all in an arena
+static bool winegrowerIndex_inArena(const tWinegrower* winegrower) {
+    tWeighingNode* pNode;
+    int i;
+
+    if (!arena_contains(winegrower->document)) {
+        return false;
+    }
+    if (winegrower->vineyardplots.count > 0 && !arena_contains(winegrower->vineyardplots.elems)) {
+        return false;
+    }
+    for (i = 0; i < winegrower->vineyardplots.count; i++) {
+        pNode = winegrower->vineyardplots.elems[i].weights.first;
+        if (pNode != NULL && !arena_contains(pNode)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Insert a winegrower in the list sorted by id and add it to the index, taking its document and vineyardplots
+tWinegrower* winegrowerIndex_insertMove(tWinegrowerIndex* index, tWinegrowerList* list, tWinegrower* winegrower) {
+    tWinegrowerNode* pNew;
+    tVineyardplotData* plots;
+    tWeighingNode* pNode;
+    tApiError error;
+    int i;
+
+    assert(index != NULL);
+    assert(list != NULL);
+    assert(winegrower != NULL);
+
+    pNew = winegrowerIndex_link(index, list, winegrower->id);
+
+    if (arena_current() != NULL && !winegrowerIndex_inArena(winegrower)) {
+        // The data of an arena only has blocks of the arena, so a winegrower of the caller with blocks outside
+        // of it is copied with its vineyardplots and weighings, and the caller keeps it
+        winegrower_cpy(&(pNew->winegrower), *winegrower);
+        plots = &(pNew->winegrower.vineyardplots);
+        for (i = 0; i < winegrower->vineyardplots.count; i++) {
+            vineyardplotData_add(plots, winegrower->vineyardplots.elems[i]);
+            for (pNode = winegrower->vineyardplots.elems[i].weights.first; pNode != NULL; pNode = pNode->next) {
+                error = weighingList_add(&(plots->elems[plots->count - 1].weights), pNode->elem);
+                assert(error == E_SUCCESS);
+            }
+        }
+    } else {
+        pNew->winegrower = *winegrower;
+
+        // The node owns the document and the vineyardplots now
+        winegrower->id = NULL;
+        winegrower->document = NULL;
+        vineyardplotData_init(&(winegrower->vineyardplots));
+    }
+
+    winegrowerIndex_add(index, pNew);
+
+    return &(pNew->winegrower);
+}
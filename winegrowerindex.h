@@ -0,0 +1,72 @@
+#ifndef __WINEGROWERINDEX_H__
+#define __WINEGROWERINDEX_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "winegrower.h"
+
+// Initial number of slots of the index. It is always a power of two
+#define WINEGROWER_INDEX_INITIAL_CAPACITY 64
+
+// Number of bytes of an id packed in a key of the ordered tree. Ids are WINEGROWERS_ID_LENGTH long, so they
+// fit. If a longer id is added, the tree is dropped and new nodes are linked walking the list
+#define WINEGROWER_TREE_KEY_SIZE 8
+
+// Maximum number of entries of a node of the ordered tree. The count and the keys of a node fill its first
+// cache line, and the items its second one
+#define WINEGROWER_TREE_ORDER 7
+
+// Alignment of the nodes of the ordered tree, the size of a cache line
+#define WINEGROWER_TREE_ALIGNMENT 64
+
+// Node of a B+tree of winegrower list nodes sorted by id. The keys are the ids packed in integers that sort
+// as the ids, so a search does not read the list nodes. Leaves hold the list node of each key. Internal nodes
+// hold their children, with the lowest key below each child
+typedef struct _tWinegrowerTreeNode {
+    int count;
+    bool leaf;
+    uint64_t keys[WINEGROWER_TREE_ORDER];
+    union {
+        tWinegrowerNode* entries[WINEGROWER_TREE_ORDER];
+        struct _tWinegrowerTreeNode* children[WINEGROWER_TREE_ORDER];
+    };
+} tWinegrowerTreeNode;
+
+// Index of a winegrower list: an open addressing hash table from id to list node for lookups, and
+// a B+tree on the id to find the insertion point of new nodes. The list keeps the in-order iteration
+typedef struct _tWinegrowerIndex {
+    tWinegrowerNode** slots;
+    int capacity;
+    int count;
+    tWinegrowerTreeNode* root;
+    bool longIds;
+} tWinegrowerIndex;
+
+// Initialize an empty index
+void winegrowerIndex_init(tWinegrowerIndex* index);
+
+// Remove all data from the index. The nodes are not released
+void winegrowerIndex_free(tWinegrowerIndex* index);
+
+// Add a node of the list to the index
+void winegrowerIndex_add(tWinegrowerIndex* index, tWinegrowerNode* node);
+
+// Index all the nodes of a list, removing previous data
+void winegrowerIndex_build(tWinegrowerIndex* index, tWinegrowerList list);
+
+// Find a winegrower of the list by id. If the index does not cover the whole list, the list is searched
+tWinegrower* winegrowerIndex_find(const tWinegrowerIndex* index, const tWinegrowerList* list, const char* id);
+
+// Find the last node of the list with an id lower than the given one. NULL if there is none. The tree must
+// be kept, that is, no id longer than WINEGROWER_TREE_KEY_SIZE was added
+tWinegrowerNode* winegrowerIndex_predecessor(const tWinegrowerIndex* index, const char* id);
+
+// Insert a copy of a winegrower in the list sorted by id and add it to the index. Return the inserted winegrower
+tWinegrower* winegrowerIndex_insert(tWinegrowerIndex* index, tWinegrowerList* list, tWinegrower winegrower);
+
+// Insert a winegrower in the list sorted by id and add it to the index, taking its document and vineyardplots
+// instead of copying them. The winegrower is left empty. With an active arena, a winegrower with blocks that
+// are not in an arena is copied instead, and the caller keeps it. Return the inserted winegrower
+tWinegrower* winegrowerIndex_insertMove(tWinegrowerIndex* index, tWinegrowerList* list, tWinegrower* winegrower);
+
+#endif